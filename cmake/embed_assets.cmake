@@ -0,0 +1,46 @@
+#[[
+Embeds files as byte arrays into a C++ header
+=============================================
+  cmake -DOUTPUT=<header> -DASSETS=<name>=<file>[;<name>=<file>...] -P embed_assets.cmake
+
+The header defines `embedded_assets[]`, one entry {name, data, size} per file.
+#]]
+
+set(declarations "")
+set(entries "")
+set(index 0)
+
+foreach(asset IN LISTS ASSETS)
+    string(FIND "${asset}" "=" split)
+    string(SUBSTRING "${asset}" 0 ${split} name)
+    math(EXPR split "${split} + 1")
+    string(SUBSTRING "${asset}" ${split} -1 file)
+
+    file(READ "${file}" hex HEX)
+    string(LENGTH "${hex}" hex_length)
+    math(EXPR size "${hex_length} / 2")
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," bytes "${hex}")
+    string(REGEX REPLACE "(0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,)" "\\1\n    " bytes "${bytes}")
+
+    string(APPEND declarations "inline constexpr unsigned char embedded_asset_${index}[${size}] = {\n    ${bytes}\n};\n\n")
+    string(APPEND entries "    {\"${name}\", embedded_asset_${index}, ${size}},\n")
+    math(EXPR index "${index} + 1")
+endforeach()
+
+file(WRITE "${OUTPUT}.tmp"
+"// Generated by embed_assets.cmake, do not edit
+#pragma once
+#include <cstddef>
+
+struct EmbeddedAsset
+{
+    const char *name;
+    const unsigned char *data;
+    size_t size;
+};
+
+${declarations}inline constexpr EmbeddedAsset embedded_assets[] = {
+${entries}};
+")
+configure_file("${OUTPUT}.tmp" "${OUTPUT}" COPYONLY)
+file(REMOVE "${OUTPUT}.tmp")
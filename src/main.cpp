@@ -18,9 +18,23 @@
 #include <random>
 #include <regex>
 #include <limits>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define HAVE_SSE 1
+#include <xmmintrin.h>
+#endif
 #include <windows.h>
 #include "json.hpp"
 #include "gif_lib.h"
+#include "embedded_assets.h"
 
 extern "C" const char *version = "0.4";
 extern "C" const char *signature = "Dragon Signature";
@@ -39,12 +53,19 @@ std::uniform_int_distribution<int> dist(0, RAND_MAX);
 
 // prototypes
 struct AppContext;
+struct OverlayWindow;
+
+struct SceneTransforms;
+struct SceneStore;
+struct SceneSnapshot;
+class QuadBatch;
 
 class ScreenObject;
 class LineObject;
 class Signature;
 class Image;
 class AnimatedGif;
+class TiledPattern;
 
 SDL_AppResult SDL_AppInit(void** appstate, int argc, char* argv[]);
 SDL_AppResult SDL_AppIterate(void *appstate);
@@ -54,17 +75,48 @@ SDL_AppResult app_init_failed();
 
 void update_screen_metrics(AppContext* app);
 void update_layout_mode(AppContext* app);
+bool overlay_window_create(AppContext *app, OverlayWindow &overlay, const SDL_Rect &bounds);
+bool overlay_renderer_create(AppContext *app, OverlayWindow &overlay, const char *driver);
+const char *render_driver_select(AppContext *app, json &objects);
+json render_driver_calibrate(AppContext *app, json &objects);
+bool benchmark_main(AppContext *app);
+json benchmark_run(AppContext *app);
+bool benchmark_compare(const json &baseline, const json &results);
+bool benchmark_gif_write(const path &file);
+void startup_report(AppContext *app);
+void overlay_window_destroy(OverlayWindow &overlay);
+void overlays_add_displays(AppContext *app);
+void overlay_event_to_scene(AppContext *app, SDL_Event *event);
+bool screen_objects_handle_event(SDL_Event *event, AppContext *app);
+int event_coalesce_burst(SDL_Event *event, int &wheel_net_steps);
+int wheel_steps(const SDL_MouseWheelEvent &wheel);
+bool key_toggles(SDL_Keycode key);
 void init_screen_objects(AppContext* app, json &objects);
 void free_screen_objects(AppContext* app);
-void draw_line_bresenham(int x1, int y1, int dx, int dy, int dash_len, int gap_len, int dash_offset, void *color, SDL_Surface* surface);
+int draw_line_bresenham(int x1, int y1, int dx, int dy, int dash_len, int gap_len, int dash_offset, Uint32 color, SDL_Surface* surface, const SDL_Rect &area);
 void draw(AppContext* app);
+bool draw_frame(AppContext* app, const SceneSnapshot &snapshot, bool rastering);
+void draw_overlay(AppContext* app, OverlayWindow &overlay, const SceneSnapshot &snapshot, bool rastering);
+void draw_scene(const SceneSnapshot &snapshot, const OverlayWindow &overlay, QuadBatch &batch, Uint32 skip_id);
+void draw_latency_hud(AppContext* app, const OverlayWindow &overlay);
+const char *latency_event_type(const SDL_Event *event, const AppContext *app);
+void latency_write(AppContext* app);
+bool drag_background_update(AppContext* app, OverlayWindow &overlay, const SceneSnapshot &snapshot);
+SDL_FPoint object_position(const AppContext *app, Uint32 slot);
+bool object_in_view(const AppContext *app, Uint32 slot, const SDL_Rect &area);
+bool object_on_screen(const AppContext *app, Uint32 slot);
+const SDL_Rect &overlay_area_at(const AppContext *app, SDL_FPoint pt);
 bool color_from_key(int key, COLORREF &color);
 string int_to_hex_color(COLORREF color);
 COLORREF get_color_value(const json& j, const string& key, COLORREF default_value);
 COLORREF hex_color_to_int(const string& hex);
 bool screen_objects_add_lines(AppContext *app);
+bool screen_objects_add_defaults(AppContext *app);
 bool screen_objects_add_text(float x, float y, const char* text, AppContext *app);
 bool screen_objects_add_image(float x, float y, const char *full_path_name, AppContext *app);
+void screen_objects_load_image(float x, float y, const char *full_path_name, AppContext *app);
+bool screen_objects_add_pattern(AppContext *app);
+bool image_is_animated(const string &full_path);
 void clipboard_insert(AppContext *app);
 double round_to_precision(double value, int decimals);
 void settings_write(AppContext* app);
@@ -80,1657 +132,5005 @@ bool settings_read(AppContext* app, json &objects);
 #define BLENDED_ALPHA_INT(img_alpha, glob_alpha) SDL_min(255, (int)(BLENDED_ALPHA_FLOAT(img_alpha, glob_alpha) * 255.f))
 
 
-struct AppContext
+// Type tags for scene objects
+enum ObjectType : Uint8
 {
-    path base_path;
-    SDL_Window *window = nullptr;
-    SDL_Renderer *renderer = nullptr;
-    SDL_AppResult app_quit = SDL_APP_CONTINUE;
-    SDL_Cursor *handCursor = nullptr;
-    Uint64 idle_ticks = 0;
-
-    HWND hwnd = nullptr;
-    SDL_Rect screen_rect_init = {-1, -1, -1, -1};  // To initialize `screen_rect` (editable in settimgs file)
-    SDL_Rect screen_rect = {0, 0, 800, 600};  // To initialize `lines_area`
-    SDL_Rect work_area = {0};  // Physical overlay window position
-    int crop_bottom = 0;  // Crops work_area
-    float center_x = 400, center_y = 300;
-
-    bool hidden = false;
-    float alpha = 0.55f;
-    bool layout_mode = false;
-    bool is_virgin = true;
-    int idle_delay_ms = 600;
-    bool needs_redraw = true;
-
-    // Mouse capturing and dragging (screen objects)
-    vector<ScreenObject*> screen_objects;
-    ScreenObject *mouse_capture = nullptr;
-    SDL_FPoint dragging_origin = {0}, dragging_offset = {0};
+    OBJECT_LINES = 0,
+    OBJECT_SIGNATURE,
+    OBJECT_IMAGE,
+    OBJECT_ANIMATED_GIF,
+    OBJECT_TILED_PATTERN,
+};
 
-    // Text (initial) properties
-    string text_file_name = "signature.txt";
-    string text_content;
-    string text_font_name = "Freeman-Regular.TTF";
-    int text_font_size = 78;
-    COLORREF text_font_color = RGB(112, 146, 190);
-    float text_scale = 0.4f;
-    float text_rotate = 0.f;
-    float text_alpha = 1.f;
 
-    // Logo (initial) properties
-    string logo_file_name = "dragon.png";
-    float logo_scale = 0.2f;
-    float logo_alpha = 1.f;
+// Type-tagged reference to a scene object.
+// `id` is stable across sessions (written to the settings file), `slot` indexes the scene's transform arrays.
+struct ObjectHandle
+{
+    Uint32 id = 0;
+    ObjectType type = OBJECT_LINES;
+    Uint32 slot = 0;
 
-    // Animated GIF
-    bool have_animations = false;
+    explicit operator bool() const { return id != 0; }
+    bool operator==(const ObjectHandle &other) const { return id == other.id; }
 };
 
 
-class ScreenObject
+// Structure-of-arrays transforms for all scene objects, one entry per slot (in draw order).
+// Slots are never reused during a session, deleted objects are only flagged.
+// (Only an object that failed to load is removed again, right after it was created.)
+struct SceneTransforms
 {
-public:
-    SDL_FPoint pos = {0, 0};
-    SDL_Rect extent = {0, 0, 0, 0};
-    float scale = 1.f;
-    float rotate = 0.f;
-    float alpha = 1.f;
-    bool deleted = false;
+    vector<Uint32> id;
+    vector<ObjectType> type;
+    vector<Uint32> index;  // Index into the per-type component array
+    vector<float> x;
+    vector<float> y;
+    vector<float> scale;
+    vector<float> rotate;
+    vector<float> alpha;
+    vector<Uint8> flip;
+    vector<Uint8> deleted;
+    vector<SDL_Rect> extent;  // (x, y) is the pivot, (w, h) the unscaled size
 
-    ScreenObject(float x, float y)
-    : pos(x, y)
-    {};
+    [[nodiscard]]
+    Uint32 size() const { return (Uint32)id.size(); }
+
+    Uint32 push(Uint32 object_id, ObjectType object_type, Uint32 component_index)
+    {
+        id.push_back(object_id);
+        type.push_back(object_type);
+        index.push_back(component_index);
+        x.push_back(0.f);
+        y.push_back(0.f);
+        scale.push_back(1.f);
+        rotate.push_back(0.f);
+        alpha.push_back(1.f);
+        flip.push_back(0);
+        deleted.push_back(0);
+        extent.push_back({0, 0, 0, 0});
+
+        return size() - 1;
+    }
 
-    virtual ~ScreenObject() = default;
-    [[nodiscard]] virtual const char* type_name() const = 0;
-    [[nodiscard]] virtual json to_json() const = 0;
-    [[nodiscard]] virtual bool valid() const = 0;
-    [[nodiscard]] virtual bool hit_test(SDL_FPoint pt) const {return false;}
-    virtual bool handle_event(const SDL_Event* event, int &needs_update, AppContext *app) = 0;
-    virtual void draw(const SDL_FPoint &pt, float alpha, const SDL_Renderer* renderer) const = 0;
+    void pop()
+    {
+        id.pop_back();
+        type.pop_back();
+        index.pop_back();
+        x.pop_back();
+        y.pop_back();
+        scale.pop_back();
+        rotate.pop_back();
+        alpha.pop_back();
+        flip.pop_back();
+        deleted.pop_back();
+        extent.pop_back();
+    }
 
+    // Tests if `pt` lies inside the oriented bounding box of `slot`.
+    // On success, `local` receives the point in unrotated, unscaled object coordinates.
     [[nodiscard]]
-    virtual bool hit_test_at_cursor() const
+    bool contains(Uint32 slot, SDL_FPoint pt, SDL_FPoint *local = nullptr) const
     {
-        SDL_FPoint pt;
+        return obb_contains({x[slot], y[slot]}, extent[slot], scale[slot], rotate[slot], pt, local);
+    }
 
-        SDL_GetGlobalMouseState(&pt.x, &pt.y);
+    // Axis-aligned bounds of the oriented box of a size `ext` (pivot `ext.x, ext.y`), placed at `center`,
+    // scaled and rotated
+    [[nodiscard]]
+    static SDL_FRect obb_bounds(SDL_FPoint center, const SDL_Rect &ext, float s, float rotate)
+    {
+        float phi = rotate * (float)M_PI / 180.f;
+        float cphi = cosf(phi);
+        float sphi = sinf(phi);
+        float min_x = center.x, max_x = center.x;
+        float min_y = center.y, max_y = center.y;
+        const SDL_FPoint corners[4] = {
+            {(float)-ext.x, (float)-ext.y},
+            {(float)(ext.w - ext.x), (float)-ext.y},
+            {(float)-ext.x, (float)(ext.h - ext.y)},
+            {(float)(ext.w - ext.x), (float)(ext.h - ext.y)}
+        };
 
-        return hit_test(pt);
+        for (const SDL_FPoint &c : corners)
+        {
+            float px = center.x + (c.x * cphi - c.y * sphi) * s;
+            float py = center.y + (c.x * sphi + c.y * cphi) * s;
+            min_x = SDL_min(min_x, px);
+            max_x = SDL_max(max_x, px);
+            min_y = SDL_min(min_y, py);
+            max_y = SDL_max(max_y, py);
+        }
+        return {min_x, min_y, max_x - min_x, max_y - min_y};
     }
 
-    static void rotate_point(SDL_FPoint ct, SDL_FPoint* pt, double phi_deg)
+    // Tests if the box of `slot`, placed at `center`, overlaps `area`
+    [[nodiscard]]
+    bool overlaps(Uint32 slot, SDL_FPoint center, const SDL_Rect &area) const
     {
-        double phi = phi_deg * M_PI / 180;
-        double dx = pt->x - ct.x;
-        double dy = pt->y - ct.y;
-        double cphi = cos(phi);
-        double sphi = sin(phi);
+        if (scale[slot] <= 0.f || extent[slot].w <= 0 || extent[slot].h <= 0) return false;
 
-        pt->x = (float)((double)ct.x + dx * cphi - dy * sphi);
-        pt->y = (float)((double)ct.y + dx * sphi + dy * cphi);
+        SDL_FRect bounds = obb_bounds(center, extent[slot], scale[slot], rotate[slot]);
+        SDL_FRect view = {(float)area.x, (float)area.y, (float)area.w, (float)area.h};
+        return SDL_HasRectIntersectionFloat(&bounds, &view);
     }
 
-    static void render_transformed_texture(
-        SDL_Texture *texture,
-        float x, float y, float w, float h,
-        float scale,
-        float rotate,
-        bool flip_x, bool flip_y,
-        float alpha,
-        const SDL_Renderer *renderer)
+    // Viewport culling: tests if `slot`, placed at `center`, overlaps `area` with its oriented bounding box.
+    // The line layer and tiled patterns cover the whole window wherever they are placed.
+    [[nodiscard]]
+    bool in_view(Uint32 slot, SDL_FPoint center, const SDL_Rect &area) const
     {
-        if (!renderer) return;
+        switch (type[slot])
+        {
+            case OBJECT_LINES:
+            case OBJECT_TILED_PATTERN:
+                return true;
+            default:
+                return overlaps(slot, center, area);
+        }
+    }
 
-        SDL_Vertex verts[4];
-        SDL_FPoint texcoords[4] = {
-            {0.f, 0.f}, {1.f, 0.f},
-            {0.f, 1.f}, {1.f, 1.f}
-        };
+    // Tests if `pt` lies inside a box of size `ext` (pivot `ext.x, ext.y`), placed at `center`, scaled and rotated
+    [[nodiscard]]
+    static bool obb_contains(
+        SDL_FPoint center,
+        const SDL_Rect &ext,
+        float s,
+        float rotate,
+        SDL_FPoint pt,
+        SDL_FPoint *local = nullptr)
+    {
+        if (s <= 0.f || ext.w <= 0 || ext.h <= 0) return false;
 
-        // Apply flipping to texcoords
-        if (flip_x) {
-            float tmp = texcoords[0].x;
-            texcoords[0].x = texcoords[1].x;
-            texcoords[1].x = tmp;
-            tmp = texcoords[2].x;
-            texcoords[2].x = texcoords[3].x;
-            texcoords[3].x = tmp;
-        }
-        if (flip_y) {
-            float tmp = texcoords[0].y;
-            texcoords[0].y = texcoords[2].y;
-            texcoords[2].y = tmp;
-            tmp = texcoords[1].y;
-            texcoords[1].y = texcoords[3].y;
-            texcoords[3].y = tmp;
-        }
-
-        // Center point
-        float cx = x + w / 2.f;
-        float cy = y + h / 2.f;
-
-        // Apply scaling
-        float hw = (w / 2.f) * scale;
-        float hh = (h / 2.f) * scale;
-
-        SDL_FPoint corners[4] = {
-            {-hw, -hh}, {+hw, -hh},
-            {-hw, +hh}, {+hw, +hh}
-        };
+        float dx = pt.x - center.x;
+        float dy = pt.y - center.y;
 
-        // Rotation
-        float angle_rad = rotate * (float)M_PI / 180.f;
-        float cos_a = cosf(angle_rad);
-        float sin_a = sinf(angle_rad);
+        if (rotate != 0.f)
+        {
+            float phi = -rotate * (float)M_PI / 180.f;
+            float cphi = cosf(phi);
+            float sphi = sinf(phi);
+            float rx = dx * cphi - dy * sphi;
+            float ry = dx * sphi + dy * cphi;
+            dx = rx;
+            dy = ry;
+        }
 
-        for (int i = 0; i < 4; i++) {
-            float rx = corners[i].x * cos_a - corners[i].y * sin_a;
-            float ry = corners[i].x * sin_a + corners[i].y * cos_a;
+        float lx = dx / s + (float)ext.x;
+        float ly = dy / s + (float)ext.y;
 
-            verts[i].position.x = cx + rx;
-            verts[i].position.y = cy + ry;
-            verts[i].color = {1.0, 1.0, 1.0, alpha};
-            verts[i].tex_coord = texcoords[i];
-        }
+        if (lx < 0.f || ly < 0.f || lx >= (float)ext.w || ly >= (float)ext.h) return false;
+        if (local) *local = {lx, ly};
 
-        int indices[6] = {0, 1, 2, 1, 3, 2};
-        SDL_RenderGeometry(
-                const_cast<SDL_Renderer*>(renderer),
-                texture,
-                verts,
-                4,
-                indices,
-                6);
+        return true;
     }
 };
 
 
-class LineObject : public ScreenObject
+// Batch builder for textured quads.
+// The corners of all queued quads are transformed in SIMD lanes at flush time, and consecutive quads sharing
+// a texture are submitted with a single SDL_RenderGeometry() call. (Runs are kept in queue order, so
+// overlapping objects are still drawn in the right order.)
+class QuadBatch
 {
+    struct Run
+    {
+        SDL_Texture *texture;
+        Uint32 first;  // First quad of the run
+        Uint32 count;  // Number of quads
+    };
 
-public:
-    int width;
-    COLORREF color;
-    bool dashed;
-    int dashed_len;
-    int dashed_gap;
-    float line_angle;
-    float line_spacing;
-    SDL_Rect work_area;
-    const Uint64 &idle_ticks;
+    // Queued quads (structure-of-arrays)
+    vector<float> cx, cy;  // Center
+    vector<float> hw, hh;  // Half width and height (scaled)
+    vector<float> cs, sn;  // Cosine and sine of the rotation angle
+    vector<Run> runs;
 
-    LineObject(
-        const SDL_Rect &work_area,
-        const Uint64 &idle_ticks,
-        int width = 1,
-        COLORREF color = 0,
-        bool dashed = true,
-        int dash_len = 10,
-        int dash_gap = 10,
-        float line_angle = 45.f,
-        float line_spacing = 15.f)
-        : ScreenObject(0, 0),
-        width(width),
-        color(color),
-        dashed(dashed),
-        dashed_len(dash_len),
-        dashed_gap(dash_gap),
-        line_angle(line_angle),
-        line_spacing(line_spacing),
-        work_area(work_area),
-        idle_ticks(idle_ticks)
-        {}
+    vector<SDL_Vertex> vertices;
+    vector<int> indices;
 
+public:
     [[nodiscard]]
-    const char* type_name() const override { return "Lines"; }
+    Uint32 size() const { return (Uint32)cx.size(); }
 
-    [[nodiscard]]
-    json to_json() const override {
-        return json{
-            {"type", type_name()},
-            {"alpha", 1.f},
-            {"width", width},
-            {"color", int_to_hex_color(color)},
-            {"dashed", dashed},
-            {"dashed_len", dashed_len},
-            {"dashed_gap", dashed_gap},
-            {"line_angle", round_to_precision(line_angle, 4)},
-            {"line_spacing", round_to_precision(line_spacing, 1)}
+    void add(
+        SDL_Texture *texture,
+        float x, float y, float w, float h,
+        float scale,
+        float rotate,
+        bool flip_x, bool flip_y,
+        float alpha)
+    {
+        if (!texture) return;
+
+        Uint32 quad = size();
+        float angle_rad = rotate * (float)M_PI / 180.f;
+        SDL_FColor color = {alpha, alpha, alpha, alpha};  // Textures are premultiplied
+        SDL_FPoint texcoords[4] = {
+            {0.f, 0.f}, {1.f, 0.f},
+            {0.f, 1.f}, {1.f, 1.f}
         };
-    }
 
-    [[nodiscard]]
-    bool valid() const override { return true; }
+        // Apply flipping to texcoords
+        if (flip_x)
+        {
+            std::swap(texcoords[0].x, texcoords[1].x);
+            std::swap(texcoords[2].x, texcoords[3].x);
+        }
+        if (flip_y)
+        {
+            std::swap(texcoords[0].y, texcoords[2].y);
+            std::swap(texcoords[1].y, texcoords[3].y);
+        }
 
-    [[nodiscard]]
-    bool hit_test(SDL_FPoint pt) const override {
-        // The line object is not selectable
-        return false;
-    }
+        cx.push_back(x + w / 2.f);
+        cy.push_back(y + h / 2.f);
+        hw.push_back((w / 2.f) * scale);
+        hh.push_back((h / 2.f) * scale);
+        cs.push_back(rotate == 0.f ? 1.f : cosf(angle_rad));
+        sn.push_back(rotate == 0.f ? 0.f : sinf(angle_rad));
 
-    bool handle_event(const SDL_Event* event, int& needs_update, AppContext* app) override {
-        if (!app->layout_mode) return false;
+        // Positions are filled in by `transform_corners()`
+        for (auto &texcoord : texcoords)
+        {
+            vertices.push_back({{0.f, 0.f}, color, texcoord});
+        }
 
-        if (event->type == SDL_EVENT_MOUSE_WHEEL)
+        if (runs.empty() || runs.back().texture != texture)
         {
-            if (SDL_GetModState() & SDL_KMOD_SHIFT)
-            {
-                // Adjust spacing
-                float scale_factor = (event->wheel.y > 0) ? 1.1f : 0.9f;
-                line_spacing *= scale_factor;
-                line_spacing = SDL_max(2.f, line_spacing);
-                line_spacing = SDL_min(50.f, line_spacing);
-                needs_update = UPDATE_SETTINGS_CHANGED;
-                app->is_virgin = false;
-                return true;
-            }
-            else if (SDL_GetModState() & SDL_KMOD_CTRL)
-            {
-                // Adjust orientation
-                float angle_delta = (event->wheel.y > 0) ? 5.f : -5.f; // degrees
-                line_angle += angle_delta;
-                needs_update = UPDATE_SETTINGS_CHANGED;
-                app->is_virgin = false;
-                return true;
-            }
+            runs.push_back({texture, quad, 0});
         }
-        else if (event->type == SDL_EVENT_KEY_DOWN)
+        runs.back().count++;
+    }
+
+    // Submits all queued quads and empties the batch
+    void flush(const SDL_Renderer *renderer)
+    {
+        Uint32 n = size();
+
+        if (n && renderer)
         {
-            COLORREF c;
-            if (color_from_key((int)event->key.key, c))
-            {
-                this->color = c;
-                needs_update = UPDATE_SETTINGS_CHANGED;
-                app->is_virgin = false;
-                return true;
-            }
-            else if (event->key.key >= SDLK_0 && event->key.key <= SDLK_5)
+            transform_corners(n);
+
+            // All runs share one index buffer, since vertices are passed relative to the run
+            if (indices.size() < (size_t)n * 6)
             {
-                this->width = (int)(event->key.key - SDLK_0);
-                needs_update = UPDATE_SETTINGS_CHANGED;
-                app->is_virgin = false;
-                return true;
+                for (Uint32 i = (Uint32)indices.size() / 6; i < n; i++)
+                {
+                    int base = (int)i * 4;
+                    int quad_indices[6] = {base, base + 1, base + 2, base + 1, base + 3, base + 2};
+                    indices.insert(indices.end(), quad_indices, quad_indices + 6);
+                }
             }
-            else if (event->key.key == SDLK_D)
+
+            for (const Run &run : runs)
             {
-                this->dashed = !this->dashed;
-                needs_update = UPDATE_SETTINGS_CHANGED;
-                app->is_virgin = false;
-                return true;
+                SDL_RenderGeometry(
+                        const_cast<SDL_Renderer*>(renderer),
+                        run.texture,
+                        &vertices[(size_t)run.first * 4],
+                        (int)run.count * 4,
+                        indices.data(),
+                        (int)run.count * 6);
             }
         }
-        return false;
+
+        clear();
     }
 
-    void draw(const SDL_FPoint& pt, float global_alpha, const SDL_Renderer* renderer) const override
+    void clear()
     {
-        if (this->width == 0) return;
-        if (!valid() || !renderer) return;
-
-        int wa_width = work_area.w;
-        int wa_height = work_area.h;
-
-        float angle_rad = line_angle * (float)M_PI / 180.f;
-        float sa = sinf(angle_rad);
-        float ca = cosf(angle_rad);
+        cx.clear();
+        cy.clear();
+        hw.clear();
+        hh.clear();
+        cs.clear();
+        sn.clear();
+        runs.clear();
+        vertices.clear();
+    }
 
-        // Line equation: -sa*x + ca*y = C
-        float c00 = 0;
-        float c10 = -sa * (float)wa_width;
-        float c01 = ca * (float)wa_height;
-        float c11 = -sa * (float)wa_width + ca * (float)wa_height;
-        float c_min = (std::min)({c00, c10, c01, c11});
-        float c_max = (std::max)({c00, c10, c01, c11});
+protected:
+    // Rotates the corners (-hw, -hh), (+hw, -hh), (-hw, +hh), (+hw, +hh) of each quad around its center:
+    //   x = cx + sx * hw * cos - sy * hh * sin
+    //   y = cy + sx * hw * sin + sy * hh * cos
+    void transform_corners(Uint32 n)
+    {
+        Uint32 i = 0;
 
-        if (this->width > 1 && !this->dashed)
+#ifdef HAVE_SSE
+        // Four quads per iteration, one per SIMD lane
+        for (; i + 4 <= n; i += 4)
         {
-            SDL_Color rgba = {
-                GetRValue(color),
-                GetGValue(color),
-                GetBValue(color),
-                SDL_min((Uint8)255, (Uint8)(global_alpha * 255.f))
-            };
-            SDL_FColor frgba = {
-                rgba.r / 255.f,
-                rgba.g / 255.f,
-                rgba.b / 255.f,
-                rgba.a / 255.f
-            };
-
-            for (float c = c_min; c < c_max; c += line_spacing)
+            alignas(16) float x[4][4], y[4][4];
+            __m128 vcx = _mm_loadu_ps(&cx[i]);
+            __m128 vcy = _mm_loadu_ps(&cy[i]);
+            __m128 vhw = _mm_loadu_ps(&hw[i]);
+            __m128 vhh = _mm_loadu_ps(&hh[i]);
+            __m128 vcs = _mm_loadu_ps(&cs[i]);
+            __m128 vsn = _mm_loadu_ps(&sn[i]);
+            __m128 a = _mm_mul_ps(vhw, vcs);
+            __m128 b = _mm_mul_ps(vhh, vsn);
+            __m128 c = _mm_mul_ps(vhw, vsn);
+            __m128 d = _mm_mul_ps(vhh, vcs);
+
+            _mm_store_ps(x[0], _mm_add_ps(_mm_sub_ps(vcx, a), b));
+            _mm_store_ps(y[0], _mm_sub_ps(_mm_sub_ps(vcy, c), d));
+            _mm_store_ps(x[1], _mm_add_ps(_mm_add_ps(vcx, a), b));
+            _mm_store_ps(y[1], _mm_sub_ps(_mm_add_ps(vcy, c), d));
+            _mm_store_ps(x[2], _mm_sub_ps(_mm_sub_ps(vcx, a), b));
+            _mm_store_ps(y[2], _mm_add_ps(_mm_sub_ps(vcy, c), d));
+            _mm_store_ps(x[3], _mm_sub_ps(_mm_add_ps(vcx, a), b));
+            _mm_store_ps(y[3], _mm_add_ps(_mm_add_ps(vcy, c), d));
+
+            // Scatter into the interleaved vertex layout SDL expects
+            for (int lane = 0; lane < 4; lane++)
             {
-                // find intersections with screen boundaries
-                vector<SDL_Point> intersections;
-
-                if (sa != 0)
-                {
-                    float x = -c / sa;
-                    if (x >= 0 && x <= (float)wa_width) intersections.push_back({(int)x, 0});
-                }
-                if (sa != 0)
-                {
-                    float x = ((float)wa_height * ca - c) / sa;
-                    if (x >= 0 && x <= (float)wa_width) intersections.push_back({(int)x, wa_height});
-                }
-                if (ca != 0)
-                {
-                    float y = c / ca;
-                    if (y >= 0 && y <= (float)wa_height) intersections.push_back({0, (int)y});
-                }
-                if (ca != 0)
-                {
-                    float y = (c + (float)wa_width * sa) / ca;
-                    if (y >= 0 && y <= (float)wa_height) intersections.push_back({wa_width, (int)y});
-                }
-
-                if (intersections.size() >= 2)
+                SDL_Vertex *v = &vertices[(size_t)(i + lane) * 4];
+                for (int k = 0; k < 4; k++)
                 {
-                    std::sort(
-                            intersections.begin(),
-                            intersections.end(),
-                            [](const SDL_Point& a, const SDL_Point& b)
-                            {
-                                if (a.x != b.x) return a.x < b.x;
-                                return a.y < b.y;
-                            }
-                    );
-                    intersections.erase(
-                            std::unique(
-                                    intersections.begin(),
-                                    intersections.end(),
-                                    [](const SDL_Point& a, const SDL_Point& b)
-                                    {
-                                        return a.x == b.x && a.y == b.y;
-                                    }
-                            ),
-                            intersections.end());
-
-                    if (intersections.size() >= 2)
-                    {
-                        SDL_Point p1 = intersections[0];
-                        SDL_Point p2 = intersections[1];
-
-                        auto dx = (float)(p2.x - p1.x);
-                        auto dy = (float)(p2.y - p1.y);
-                        float len = sqrtf(dx*dx + dy*dy);
-                        if (len == 0) continue;
-                        float nx = -dy / len;
-                        float ny = dx / len;
-                        float w = (float)width / 2.f;
-
-                        SDL_Vertex verts[4];
-                        verts[0].position = { (float)p1.x + nx * w, (float)p1.y + ny * w };
-                        verts[0].color = frgba;
-                        verts[0].tex_coord = { 0, 0 };
-                        verts[1].position = { (float)p1.x - nx * w, (float)p1.y - ny * w };
-                        verts[1].color = frgba;
-                        verts[1].tex_coord = { 0, 0 };
-                        verts[2].position = { (float)p2.x + nx * w, (float)p2.y + ny * w };
-                        verts[2].color = frgba;
-                        verts[2].tex_coord = { 0, 0 };
-                        verts[3].position = { (float)p2.x - nx * w, (float)p2.y - ny * w };
-                        verts[3].color = frgba;
-                        verts[3].tex_coord = { 0, 0 };
-
-                        int indices[] = { 0, 1, 2, 1, 3, 2 };
-                        SDL_RenderGeometry(
-                            const_cast<SDL_Renderer *>(renderer),
-                            nullptr,
-                            verts,
-                            4,
-                            indices,
-                            6);
-                    }
+                    v[k].position = {x[k][lane], y[k][lane]};
                 }
             }
         }
-        else
+#endif
+
+        // Remaining quads (or all, without SIMD support)
+        for (; i < n; i++)
         {
-            int gap_len = this->dashed ? this->dashed_gap : 0;
-            int dash_len = this->dashed_len;
-            int quarter_dash_len = (dash_len + 2) / 4;
-            Uint32 pixel;
-            SDL_Surface *surface;
-            SDL_Texture *texture;
+            float a = hw[i] * cs[i];
+            float b = hh[i] * sn[i];
+            float c = hw[i] * sn[i];
+            float d = hh[i] * cs[i];
+            SDL_Vertex *v = &vertices[(size_t)i * 4];
+
+            v[0].position = {cx[i] - a + b, cy[i] - c - d};
+            v[1].position = {cx[i] + a + b, cy[i] + c - d};
+            v[2].position = {cx[i] - a - b, cy[i] - c + d};
+            v[3].position = {cx[i] + a - b, cy[i] + c + d};
+        }
+    }
+};
 
-            gen.seed((unsigned)idle_ticks);
-            surface = SDL_CreateSurface(wa_width, wa_height, SDL_PIXELFORMAT_RGBA8888);
-            SDL_ClearSurface(surface, 0, 0, 0, 0);
 
-            pixel = SDL_MapSurfaceRGBA(
-                        surface,
-                        GetRValue(this->color),
-                        GetGValue(this->color),
-                        GetBValue(this->color),
-                        SDL_min((Uint8)255, (Uint8)(global_alpha * 255.f)));
+// Read-only view of a whole file
+struct MappedFile
+{
+    const Uint8 *data;
+    size_t size;
+};
 
-            SDL_LockSurface(surface);
 
-            for (float c = c_min; c < c_max; c += line_spacing)
-            {
-                int dash_offset = this->dashed ? dist(gen) % (dash_len + gap_len) : 0;
-                vector<SDL_Point> intersections;
+// Decoded assets and their textures, shared by all overlay windows.
+// Image files are decoded once, objects showing the same file share the surface (reference counted).
+// Source files are read through shared read-only file mappings, backed by the page cache instead of stdio buffers.
+// (Images and fonts are decoded from the mapped bytes, giflib still copies each block out of the mapping.)
+// The default logo and font are built into the binary and served from there if there is no such file on disk.
+// SDL textures belong to one renderer, so each window gets its own upload of the shared surface.
+// Uploads are keyed by an owner (object or GIF frame) and tagged with a content version,
+// the owner bumps the version whenever its surface content changes.
+// Uploads are made by the render thread while the main thread may drop them (`mutex`): dropped textures
+// are only destroyed by the next `collect()`, the frame that may still have queued them is done by then.
+class AssetCache
+{
+    struct SharedSurface
+    {
+        SDL_Surface *surface;
+        int refs;
+    };
 
-                if (sa != 0)
-                {
-                    float x = -c / sa;
-                    if (x >= 0 && x <= (float)wa_width) intersections.push_back({(int)x, 0});
-                }
-                if (sa != 0)
-                {
-                    float x = ((float)wa_height * ca - c) / sa;
-                    if (x >= 0 && x <= (float)wa_width) intersections.push_back({(int)x, wa_height});
-                }
-                if (ca != 0)
-                {
-                    float y = c / ca;
-                    if (y >= 0 && y <= (float)wa_height) intersections.push_back({0, (int)y});
-                }
-                if (ca != 0)
-                {
-                    float y = (c + (float)wa_width * sa) / ca;
-                    if (y >= 0 && y <= (float)wa_height) intersections.push_back({wa_width, (int)y});
-                }
+    struct Upload
+    {
+        SDL_Texture *texture;
+        Uint32 version;
+    };
 
-                if (intersections.size() >= 2)
-                {
-                    std::sort(
-                            intersections.begin(),
-                            intersections.end(),
-                            [](const SDL_Point& a, const SDL_Point& b)
-                            {
-                                if (a.x != b.x) return a.x < b.x;
-                                return a.y < b.y;
-                            }
-                    );
-                    intersections.erase(
-                            std::unique(intersections.begin(),
-                                        intersections.end(),
-                                        [](const SDL_Point& a, const SDL_Point& b)
-                                        {
-                                            return a.x == b.x && a.y == b.y;
-                                        }
-                            ),
-                            intersections.end());
-
-                    if (intersections.size() >= 2)
-                    {
-                        SDL_Point p1 = intersections[0];
-                        SDL_Point p2 = intersections[1];
-                        int dx = p2.x - p1.x;
-                        int dy = p2.y - p1.y;
-                        int jitter = 0;
-
-                        if (abs(dx) > abs(dy))
-                        { // more horizontal
-                            for (int d = -(this->width - 1) / 2; d <= this->width / 2; d++)
-                            {
-                                if (this->dashed)
-                                {
-                                    jitter = (dist(gen) % max(4, quarter_dash_len)) - quarter_dash_len / 2;
-                                }
-                                draw_line_bresenham(
-                                    p1.x, p1.y + d,
-                                    dx, dy,
-                                    dash_len, gap_len, dash_offset + jitter,
-                                    &pixel,
-                                    surface);
-                            }
-                        }
-                        else
-                        { // more vertical
-                            for (int d = -(this->width - 1) / 2; d <= this->width / 2; d++)
-                            {
-                                if (this->dashed)
-                                {
-                                    jitter = (dist(gen) % max(4, quarter_dash_len)) - quarter_dash_len / 2;
-                                }
-                                draw_line_bresenham(
-                                    p1.x + d, p1.y,
-                                    dx, dy,
-                                    dash_len, gap_len,
-                                    dash_offset + jitter,
-                                    &pixel, surface);
-                            }
-                        }
-                    }
-                }
-            }
+    struct SharedMapping
+    {
+        HANDLE file;
+        HANDLE mapping;
+        MappedFile view;
+        int refs;
+    };
 
-            SDL_UnlockSurface(surface);
+    std::unordered_map<string, SharedSurface> files;
+    std::unordered_map<string, SharedMapping> mappings;
+    std::unordered_map<string, MappedFile> embedded;  // Built-in files by `embedded_key()`
+    std::unordered_map<const TTF_Font *, const MappedFile *> font_sources;
+    std::map<std::pair<const void *, const SDL_Renderer *>, Upload> uploads;
+    vector<SDL_Texture *> retired;  // Dropped uploads, destroyed by `collect()`
 
-            texture = SDL_CreateTextureFromSurface(const_cast<SDL_Renderer *>(renderer), surface);
-            SDL_ClearSurface(surface, 0, 0, 0, 0);
-            SDL_DestroySurface(surface);
+public:
+    // Guards the uploads and the surfaces of the scene objects: the render thread holds it while it draws
+    // an object (uploads, composes GIF frames), the main thread while it reads or recolors a surface
+    std::recursive_mutex mutex;
 
-            if (texture)
+    // Pixel format of all surfaces, chosen once from the renderer's texture formats.
+    // Surfaces are produced in this format with premultiplied alpha, so texture uploads need
+    // no conversion pass and textures are composited with SDL_BLENDMODE_BLEND_PREMULTIPLIED.
+    SDL_PixelFormat pixel_format = SDL_PIXELFORMAT_ARGB8888;
+    int max_texture_size = 0;  // Of the renderer (0: unknown)
+
+    void select_pixel_format(SDL_Renderer *renderer)
+    {
+        SDL_PropertiesID props = SDL_GetRendererProperties(renderer);
+        auto formats = (const SDL_PixelFormat *)SDL_GetPointerProperty(
+                props,
+                SDL_PROP_RENDERER_TEXTURE_FORMATS_POINTER,
+                nullptr);
+        max_texture_size = (int)SDL_GetNumberProperty(props, SDL_PROP_RENDERER_MAX_TEXTURE_SIZE_NUMBER, 0);
+
+        // The renderer lists its preferred formats first, take the first 8 bit RGBA one
+        for (; formats && *formats != SDL_PIXELFORMAT_UNKNOWN; formats++)
+        {
+            if (*formats == SDL_PIXELFORMAT_ARGB8888 || *formats == SDL_PIXELFORMAT_ABGR8888 ||
+                *formats == SDL_PIXELFORMAT_RGBA8888 || *formats == SDL_PIXELFORMAT_BGRA8888)
             {
-                SDL_FRect rect = {0, 0, (float)wa_width, (float)wa_height};
-                SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
-                SDL_RenderTexture(const_cast<SDL_Renderer *>(renderer), texture, nullptr, &rect);
-                SDL_DestroyTexture(texture);
+                pixel_format = *formats;
+                break;
             }
         }
+        SDL_Log("Pixel format: %s", SDL_GetPixelFormatName(pixel_format));
     }
-};
-
-
-class Signature : public ScreenObject
-{
-public:
-    string text;
-
-    string font_name;
-    float font_size;
-    COLORREF font_color;
-    const SDL_Renderer *renderer;
-    SDL_Texture *texture;
-    SDL_Surface *surface;
 
-    Signature(
-        const string &signature,
-        float x,
-        float y,
-        const string &font_name,
-        float font_size,
-        COLORREF font_color,
-        const path &font_path,
-        float scale_by,
-        float rotate_by,
-        float alpha,
-        const SDL_Renderer *renderer)
-        : ScreenObject(x, y),
-          texture(nullptr),
-          surface(nullptr),
-          renderer(renderer)
+    // Brings a straight alpha `surface` into the pixel format and premultiplies it (takes ownership)
+    [[nodiscard]]
+    SDL_Surface *to_native(SDL_Surface *surface) const
     {
-        init(signature, x, y, font_name, font_size, font_color, font_path, scale_by, rotate_by, alpha);
-    }
+        if (!surface) return nullptr;
 
-    Signature(json &j, path &font_path, const SDL_Renderer *renderer)
-    : ScreenObject(-1, -1),
-      texture(nullptr),
-      surface(nullptr),
-      renderer(renderer)
-    {
-        try
+        if (surface->format != pixel_format)
         {
-            init(
-                j.value("text", "Example"),
-                j["x"], j["y"],
-                j.value("font_name", "Freeman-Regular.TTF"),
-                j.value("font_size", 80.f),
-                get_color_value(j, "font_color", 0xffffff),
-                font_path,
-                j.value("scale", 1.f),
-                j.value("rotate", 0.f),
-                j.value("alpha", 1.f));
+            SDL_Surface *converted = SDL_ConvertSurface(surface, pixel_format);
+            SDL_DestroySurface(surface);
+            surface = converted;
         }
-        catch (const std::exception &e)
+        if (surface && !SDL_PremultiplySurfaceAlpha(surface, false))
         {
-            SDL_Log("Error creating signature: %s", e.what());
+            SDL_Log("Failed to premultiply surface: %s", SDL_GetError());
         }
+        return surface;
     }
 
+    // Tells if `surface` can be uploaded (textures are created when first drawn, so objects check this up front)
     [[nodiscard]]
-    const char* type_name() const override {return "Signature";}
-
-    ~Signature() override
+    bool fits_texture(const SDL_Surface *surface) const
     {
-        SDL_DestroyTexture(texture);
-        texture = nullptr;
-        SDL_DestroySurface(surface);
-        surface = nullptr;
+        return surface && (max_texture_size <= 0 || (surface->w <= max_texture_size && surface->h <= max_texture_size));
     }
 
-protected:
-    void init(
-        const string &signature,
-        float x,
-        float y,
-        const string &font_name,
-        float font_size,
-        COLORREF font_color,
-        const path &font_path,
-        float scale_by,
-        float rotate_by,
-        float alpha)
+    // Texture from a premultiplied surface
+    static SDL_Texture *create_texture(const SDL_Renderer *renderer, const SDL_Surface *surface)
     {
-        TTF_Font* font = nullptr;
-        const SDL_PixelFormatDetails *format_details;
-
-        // TTF_RenderText_Blended() creates an ARGB surface
-        format_details = SDL_GetPixelFormatDetails(SDL_PIXELFORMAT_ARGB8888);
-
-        pos.x = x;
-        pos.y = y;
-        scale = scale_by;
-        rotate = rotate_by;
-        text = signature;
-        this->font_name = font_name;
-        this->font_size = font_size;
-        this->font_color = font_color;
-        this->alpha = alpha;
+        SDL_Texture *texture = SDL_CreateTextureFromSurface(
+                const_cast<SDL_Renderer *>(renderer),
+                const_cast<SDL_Surface *>(surface));
 
-        for (;;)
+        if (texture)
         {
-            auto font_fullpath = font_path / font_name;
-            if (!renderer) break;
-
-            font = TTF_OpenFont(font_fullpath.string().c_str(), font_size);
-            if (!font) break;
-
-            // render the font to a surface
-            // ()
-            surface = TTF_RenderText_Blended(
-                font,
-                signature.c_str(), signature.length(),
-                SDL_Color(
-                        GetBValue(font_color),
-                        GetGValue(font_color),
-                        GetRValue(font_color),
-                        (int)(alpha * 255.f))
-            );
-            if (!surface) break;
-
-            // make a texture from the surface
-            texture = SDL_CreateTextureFromSurface(const_cast<SDL_Renderer *>(renderer), surface);
-            if (!texture) break;
-
-            // get the on-screen dimensions of the text. this is necessary for rendering it
-            auto props = SDL_GetTextureProperties(texture);
-            if (!props) break;
-            extent = {
-                .w = (int)SDL_GetNumberProperty(props, SDL_PROP_TEXTURE_WIDTH_NUMBER, 0),
-                .h = (int)SDL_GetNumberProperty(props, SDL_PROP_TEXTURE_HEIGHT_NUMBER, 0)
-            };
-            extent.x = extent.w / 2;
-            extent.y = extent.h / 2;
-            break;
+            SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND_PREMULTIPLIED);
         }
-
-        // we no longer need the font or the surface, so we can destroy those now.
-        TTF_CloseFont(font);
+        return texture;
     }
 
-public:
-    [[nodiscard]]
-    json to_json() const override
+    // Loads an image file in the pixel format, or shares the surface decoded before
+    SDL_Surface *load_surface(const string &full_path)
     {
-        if (!valid()) return json::object();
-
-        return json( {
-             {"x", (int)pos.x},
-             {"y", (int)pos.y},
-             {"text", text},
-             {"scale", round_to_precision(scale, 4)},
-             {"rotate", round_to_precision(rotate, 4)},
-             {"alpha", round_to_precision(alpha, 2)},
-             {"font_name", font_name},
-             {"font_size", round_to_precision(font_size, 1)},
-             {"font_color", int_to_hex_color(font_color)},
-             {"type", type_name()}
-        } );
-    }
+        auto it = files.find(full_path);
+        if (it != files.end())
+        {
+            it->second.refs++;
+            return it->second.surface;
+        }
 
-    [[nodiscard]]
-    bool valid() const override
-    {
-        return (bool) texture && !deleted;
+        // Decoded straight from the mapped bytes, the mapping is only needed while decoding
+        SDL_Surface *surface = nullptr;
+        if (const MappedFile *file = map_file(full_path))
+        {
+            surface = to_native(IMG_Load_IO(SDL_IOFromConstMem(file->data, file->size), true));
+            unmap_file(file);
+        }
+        else
+        {
+            surface = to_native(IMG_Load(full_path.c_str()));
+        }
+        if (surface)
+        {
+            files[full_path] = {surface, 1};
+        }
+        return surface;
     }
 
-    [[nodiscard]]
-    bool hit_test(SDL_FPoint pt) const override
+    // Takes over `surface` decoded elsewhere (e.g. on the job system) as the surface of an image file,
+    // objects loading the file afterwards share it. Returns the file's surface with a reference for the caller
+    // (release it once the objects hold their own).
+    SDL_Surface *add_surface(const string &full_path, SDL_Surface *surface)
     {
-        if (!valid()) return false;
-
-        SDL_FRect rc = {
-            pos.x - (float)extent.x * scale,
-            pos.y - (float)extent.y * scale,
-            (float)extent.w * scale,
-            (float)extent.h * scale
-        };
-        if (rotate != 0.0)
+        auto it = files.find(full_path);
+        if (it != files.end())
         {
-            rotate_point(pos, &pt, -rotate);
+            SDL_DestroySurface(surface);
+            it->second.refs++;
+            return it->second.surface;
         }
-        return SDL_PointInRectFloat(&pt, &rc);
+        files[full_path] = {surface, 1};
+        return surface;
     }
 
-    bool handle_event(const SDL_Event* event, int &needs_update, AppContext *app) override
+    void release_surface(SDL_Surface *surface)
     {
-        if (!app->layout_mode || !valid()) return false;
+        if (!surface) return;
 
-        if (event->type == SDL_EVENT_MOUSE_WHEEL)
+        for (auto it = files.begin(); it != files.end(); ++it)
         {
-            SDL_FPoint pt(event->wheel.mouse_x, event->wheel.mouse_y);
-
-            if (hit_test(pt))
+            if (it->second.surface == surface)
             {
-                if (SDL_GetModState() & SDL_KMOD_CTRL)
-                {
-                    // Rotate text (when ctrl is pressed)
-                    SDL_FPoint ct(pt.x, pt.y);
-                    double phi_delta = 5 * (event->wheel.y < 0 ? -1 : 1);
-                    rotate_point(ct, &pos, phi_delta);
-                    rotate += (float) phi_delta;
-                }
-                else if (SDL_GetModState() & SDL_KMOD_SHIFT)
-                {
-                    // Scale text
-                    float dScale = powf(1.1f, event->wheel.y);
-                    scale *= dScale;
-                    pos.x += (float) ((pos.x - pt.x) * (dScale - 1.0));
-                    pos.y += (float) ((pos.y - pt.y) * (dScale - 1.0));
-                }
-                else
+                if (--it->second.refs == 0)
                 {
-                    // Change text alpha
-                    if (event->wheel.y < 0)
-                    {
-                        alpha = SDL_max(0.f, alpha - (5.f / 255.f));
-                    }
-                    else
-                    {
-                        alpha = SDL_min(1.f, alpha + (5.f / 255.f));
-                    }
-                    needs_update = UPDATE_SETTINGS_CHANGED;
-                    return true;
+                    SDL_DestroySurface(surface);
+                    files.erase(it);
                 }
-                needs_update = UPDATE_SETTINGS_CHANGED;
-                return true;
+                return;
             }
         }
+    }
 
-        else if (event->type == SDL_EVENT_MOUSE_BUTTON_DOWN)
+    // Serves the built-in assets as files in `dir`, where these files don't exist on disk
+    void add_embedded(const path &dir)
+    {
+        for (const EmbeddedAsset &asset : embedded_assets)
         {
-            SDL_FPoint pt(event->motion.x, event->motion.y);
-
-            if (hit_test(pt))
-            {
-                // Start mouse capturing (dragging object)
-                app->mouse_capture = this;
-                app->dragging_origin = pt;
-                app->dragging_offset = SDL_FPoint(
-                    pt.x - pos.x,
-                    pt.y - pos.y
-                );
-                return true;
-            }
+            embedded[embedded_key(dir / asset.name)] = {asset.data, asset.size};
         }
+    }
 
-        else if (event->type == SDL_EVENT_MOUSE_BUTTON_UP)
+    // Maps a file read-only, or shares the mapping made before (nullptr on failure, e.g. empty files).
+    // A built-in file is returned as is if the file can't be opened (a file on disk replaces it).
+    const MappedFile *map_file(const string &full_path)
+    {
+        auto it = mappings.find(full_path);
+        if (it != mappings.end())
         {
-            if (app->mouse_capture == this)
-            {
-                // Stop mouse capturing (dragging object)
-                pos = app->dragging_origin;
-                pos.x -= app->dragging_offset.x;
-                pos.y -= app->dragging_offset.y;
-                app->mouse_capture = nullptr;
-                app->dragging_offset = {0};
-                needs_update = UPDATE_SETTINGS_CHANGED;
-                return true;
-            }
+            it->second.refs++;
+            return &it->second.view;
         }
 
-        else if (event->type == SDL_EVENT_MOUSE_MOTION)
+        HANDLE file = CreateFileA(
+                full_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
         {
-            SDL_FPoint pt(event->motion.x, event->motion.y);
-
-            if (app->mouse_capture == this)
-            {
-                app->dragging_origin = pt;
-                needs_update = UPDATE_VIEW_CHANGED;
-                return true;
-            }
-            else
-            {
-                // Show hand cursor when hovering over object
-                if (!app->mouse_capture && hit_test(pt))
-                {
-                    SDL_SetCursor(app->handCursor);
-                    return true;
-                }
-            }
+            auto builtin = embedded.find(embedded_key(full_path));
+            return (builtin != embedded.end()) ? &builtin->second : nullptr;
         }
 
-        else if (event->type == SDL_EVENT_KEY_DOWN)
+        LARGE_INTEGER size;
+        HANDLE mapping = nullptr;
+        const void *data = nullptr;
+
+        if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
         {
-            COLORREF color;
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        }
+        if (mapping)
+        {
+            data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        }
+        if (!data)
+        {
+            if (mapping) CloseHandle(mapping);
+            CloseHandle(file);
+            return nullptr;
+        }
 
-            if (color_from_key((int) event->key.key, color))
-            {
-                if (hit_test_at_cursor())
-                {
-                    change_color((int) color, app->renderer);
-                    needs_update = UPDATE_SETTINGS_CHANGED;
-                    return true;
-                }
-            }
-            else if (event->key.key == SDLK_DELETE)
+        SharedMapping &shared = mappings[full_path];
+        shared = {file, mapping, {(const Uint8 *)data, (size_t)size.QuadPart}, 1};
+        return &shared.view;
+    }
+
+    // (Built-in files are not found and stay)
+    void unmap_file(const MappedFile *view)
+    {
+        if (!view) return;
+
+        for (auto it = mappings.begin(); it != mappings.end(); ++it)
+        {
+            if (&it->second.view == view)
             {
-                if (hit_test_at_cursor())
+                if (--it->second.refs == 0)
                 {
-                    deleted = true;
-                    needs_update = UPDATE_SETTINGS_CHANGED;
-                    return true;
+                    close_mapping(it->second);
+                    mappings.erase(it);
                 }
+                return;
             }
         }
-
-        return false;
     }
 
-    void draw(const SDL_FPoint &pt, float alpha, const SDL_Renderer *renderer) const override
+    // Opens a font from its mapped file, the mapping is held until `close_font()`
+    TTF_Font *open_font(const string &full_path, float size)
     {
-        if (valid() && renderer && renderer == this->renderer)
+        const MappedFile *file = map_file(full_path);
+        if (!file) return TTF_OpenFont(full_path.c_str(), size);
+
+        TTF_Font *font = TTF_OpenFontIO(SDL_IOFromConstMem(file->data, file->size), true, size);
+        if (font)
         {
-            SDL_FRect rc = {
-                pt.x - (float)extent.x * scale,
-                pt.y - (float)extent.y * scale,
-                (float)extent.w * scale,
-                (float)extent.h * scale
-            };
-            SDL_SetTextureAlphaMod(texture, BLENDED_ALPHA_INT(this->alpha, alpha));
-            SDL_RenderTextureRotated(
-                    const_cast<SDL_Renderer*>(renderer),
-                            texture,
-                            nullptr,
-                            &rc,
-                            rotate,
-                            nullptr,
-                            SDL_FLIP_NONE);
+            font_sources[font] = file;
         }
+        else
+        {
+            unmap_file(file);
+        }
+        return font;
     }
 
-    bool change_color(COLORREF color, const SDL_Renderer *renderer)
+    void close_font(TTF_Font *font)
     {
-        if (!valid() || !renderer || renderer != this->renderer || !surface) return false;
-
-        auto pixels = (Uint32*)surface->pixels;
-        auto format_details = SDL_GetPixelFormatDetails(surface->format);
-        int totalPixels = surface->w * surface->h;
+        if (!font) return;
 
-        for (int i = 0; i < totalPixels; ++i)
+        TTF_CloseFont(font);
+        auto it = font_sources.find(font);
+        if (it != font_sources.end())
         {
-            Uint8 r, g, b, a;
-            SDL_GetRGBA(pixels[i], format_details, nullptr, &r, &g, &b, &a);
-
-            Uint32 px = SDL_MapRGBA(format_details, nullptr, GetRValue(color), GetGValue(color), GetBValue(color), a); // grayscale RGB from alpha
-            pixels[i] = px;
+            unmap_file(it->second);
+            font_sources.erase(it);
         }
+    }
 
-        SDL_Texture* new_texture = SDL_CreateTextureFromSurface(const_cast<SDL_Renderer*>(renderer), surface);
+    // Texture of `owner` for `renderer`, (re)uploaded from `surface` if missing or outdated.
+    // Without a surface only an up-to-date upload is returned. A failed upload isn't tried again for the same version.
+    SDL_Texture *texture(const void *owner, Uint32 version, const SDL_Surface *surface, const SDL_Renderer *renderer)
+    {
+        std::lock_guard lock(mutex);
+        auto key = std::make_pair(owner, renderer);
+        auto it = uploads.find(key);
 
-        if (!new_texture) return false;
-        SDL_DestroyTexture(texture);
-        texture = new_texture;
-        font_color = color;
+        if (it != uploads.end() && it->second.version == version) return it->second.texture;
+        if (!surface || !renderer) return nullptr;
 
-        return true;
-    }
-
-};
+        SDL_Texture *texture = create_texture(renderer, surface);
+        if (!texture)
+        {
+            SDL_Log("Failed to upload texture: %s", SDL_GetError());
+        }
 
+        if (it != uploads.end())
+        {
+            if (it->second.texture) retired.push_back(it->second.texture);
+            it->second = {texture, version};
+        }
+        else
+        {
+            uploads[key] = {texture, version};
+        }
+        return texture;
+    }
 
-class Image : public ScreenObject
-{
-public:
-    string name;
-    string full_path;
-    float scale;
-    float rotate;
-    float alpha;
-    bool flip_horizontal;
-    const SDL_Renderer *renderer;
-    SDL_Surface *surface;
-    SDL_Texture *texture;
+    // Drops all uploads of `owner`
+    void forget(const void *owner)
+    {
+        std::lock_guard lock(mutex);
+        auto it = uploads.lower_bound(std::make_pair(owner, (const SDL_Renderer *)nullptr));
 
-protected:
-    Image(float x, float y, const SDL_Renderer *renderer = nullptr)
-    : ScreenObject(x, y),
-    surface((SDL_Surface*)nullptr),
-    texture((SDL_Texture*)nullptr),
-    renderer(renderer)
-    {}
+        while (it != uploads.end() && it->first.first == owner)
+        {
+            if (it->second.texture) retired.push_back(it->second.texture);
+            it = uploads.erase(it);
+        }
+    }
 
-public:
-    Image(
-        float x, float y,
-        const string &name,
-        const path &base_path,
-        float scale_by,
-        float rotate_by,
-        bool flip_horizontal,
-        float alpha,
-        const SDL_Renderer *renderer)
-        : ScreenObject(x, y),
-          surface((SDL_Surface*)nullptr),
-          texture((SDL_Texture*)nullptr),
-          renderer(renderer)
+    // Destroys the dropped uploads (the thread using the renderers, before it queues a frame)
+    void collect()
     {
-        full_path = (base_path / name).string();
-        init(x, y, name, full_path, scale_by, rotate_by, flip_horizontal, alpha);
+        vector<SDL_Texture *> textures;
+        {
+            std::lock_guard lock(mutex);
+            textures.swap(retired);
+        }
+        for (SDL_Texture *texture : textures)
+        {
+            SDL_DestroyTexture(texture);
+        }
     }
 
-    Image(json &j, const SDL_Renderer *renderer)
-    : ScreenObject(-1, -1),
-    surface((SDL_Surface*)nullptr),
-    texture((SDL_Texture*)nullptr),
-    renderer(renderer)
+    // Releases everything, must be called before the renderers are destroyed (and with the render thread stopped)
+    void clear()
     {
-        try
+        collect();
+        for (auto &[key, upload] : uploads)
         {
-            init(
-                j["x"], j["y"],
-                j.value("image_name", ""),
-                j.value("image_full_path", ""),
-                j.value("scale", 1.f),
-                j.value("rotate", 0.f),
-                j.value("flip_horizontal", false),
-                j.value("alpha", 1.f));
+            if (upload.texture) SDL_DestroyTexture(upload.texture);
         }
-        catch (const std::exception &e)
+        uploads.clear();
+
+        for (auto &[file, shared] : files)
         {
-            SDL_Log("Error creating image: %s", e.what());
+            SDL_DestroySurface(shared.surface);
         }
-    }
+        files.clear();
 
-    [[nodiscard]]
-    const char* type_name() const override {return "Image";}
+        for (auto &[file, shared] : mappings)
+        {
+            close_mapping(shared);
+        }
+        mappings.clear();
+    }
 
-    ~Image() override
+private:
+    // Paths are case-insensitive on Windows
+    static string embedded_key(const path &full_path)
     {
-        SDL_DestroySurface(surface);
-        surface = nullptr;
-        SDL_DestroyTexture(texture);
-        texture = nullptr;
-    };
+        string key = full_path.lexically_normal().string();
+
+        std::transform(
+                key.begin(),
+                key.end(),
+                key.begin(),
+                [](unsigned char c){ return std::tolower(c); });
+        return key;
+    }
 
-protected:
-    void init(
-            float x, float y,
-            const string &name,
-            const string &full_path,
-            float scale_by,
-            float rotate_by,
-            bool flip_horizontal,
-            float alpha)
+    static void close_mapping(SharedMapping &shared)
     {
-        this->name = name;
-        this->full_path = full_path;
-        pos.x = x;
-        pos.y = y;
-        scale = scale_by;
-        rotate = rotate_by;
-        this->flip_horizontal = flip_horizontal;
-        this->alpha = alpha;
+        UnmapViewOfFile(shared.view.data);
+        CloseHandle(shared.mapping);
+        CloseHandle(shared.file);
+    }
+};
 
-        if (!this->renderer) return;
+AssetCache asset_cache;
 
-        // load the Image
-        surface = IMG_Load(full_path.c_str());
 
-        if (!surface)
+// Priorities of pool tasks, interactive work (rasters for the screen) goes ahead of background work (preloading)
+enum JobPriority : Uint8
+{
+    JOB_INTERACTIVE = 0,
+    JOB_BACKGROUND,
+    JOB_PRIORITIES
+};
+
+// Shared cancellation flag of a group of tasks (e.g. all work for one asset)
+using CancelToken = std::shared_ptr<std::atomic<bool>>;
+
+inline CancelToken make_cancel_token() { return std::make_shared<std::atomic<bool>>(false); }
+
+inline bool is_cancelled(const CancelToken &token) { return token && token->load(); }
+
+
+// Work-stealing thread pool shared by all CPU-heavy work.
+// Each worker owns one deque per priority: it takes its own newest task first and steals the oldest
+// tasks of the others when it runs dry, higher priorities always first.
+// Tasks whose token is cancelled before they start are dropped, running tasks check the token themselves.
+// The scene belongs to the main thread (and the renderers to the render thread): tasks hand results over
+// as continuations, which run in the event loop on a `main_event`.
+class JobSystem
+{
+public:
+    using Task = std::function<void()>;
+
+    // Event type posted when continuations are pending (registered at startup)
+    inline static Uint32 main_event = 0;
+
+    ~JobSystem()
+    {
+        if (!threads.empty()) stop();
+    }
+
+    // Starts `count` workers (at least one)
+    void start(int count)
+    {
+        stopping = false;
+        count = SDL_max(1, count);
+        for (int i = 0; i < count; i++)
         {
-            SDL_Log("Error loading \"%s\":\n   %s", name.c_str(), SDL_GetError());
+            workers.push_back(std::make_unique<Worker>());
         }
-        else
+        for (int i = 0; i < count; i++)
         {
-            // Convert the surface to RGBA8888 format
-            SDL_Surface *rgba_surface = SDL_ConvertSurface(surface, SDL_PIXELFORMAT_RGBA8888);
-            SDL_DestroySurface(surface);
-            surface = nullptr;
-            if (rgba_surface)
-            {
-                surface = rgba_surface;
-                if (SDL_GetSurfaceClipRect(rgba_surface, &extent))
-                {
-                    extent.x = extent.w / 2;
-                    extent.y = extent.h / 2;
-                    texture = SDL_CreateTextureFromSurface(const_cast<SDL_Renderer *>(renderer), rgba_surface);
-                }
-            }
+            threads.emplace_back([this, i] { run(i); });
         }
+    }
 
-        if (!texture)
+    // Joins the workers once they have run all queued tasks (cancel their tokens first to skip them).
+    // Continuations that haven't run yet are dropped.
+    void stop()
+    {
         {
-            SDL_DestroySurface(surface);
-            surface = nullptr;
+            std::lock_guard lock(sleep_mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &thread : threads)
+        {
+            thread.join();
         }
+        threads.clear();
+        workers.clear();
+        std::lock_guard lock(main_mutex);
+        continuations.clear();
     }
 
-public:
     [[nodiscard]]
-    json to_json() const override
+    int worker_count() const { return (int)workers.size(); }
+
+    // Queues `task`, on the calling worker's own deque or round-robin from other threads.
+    // Runs `task` in place if the pool isn't running.
+    void submit(Task task, JobPriority priority = JOB_BACKGROUND, CancelToken token = nullptr)
     {
-        if (!valid()) return json::object();
+        if (workers.empty())
+        {
+            if (!is_cancelled(token)) task();
+            return;
+        }
 
-        return json( {
-             {"x", (int)pos.x},
-             {"y", (int)pos.y},
-             {"image_name", name},
-             {"image_full_path", full_path},
-             {"scale", round_to_precision(scale, 4)},
-             {"rotate", round_to_precision(rotate, 4)},
-             {"flip_horizontal", (bool)flip_horizontal},
-             {"alpha", round_to_precision(alpha, 2)},
-             {"type", type_name()}
-        });
+        int index = current_worker >= 0 ? current_worker : (int)(next_worker++ % workers.size());
+        {
+            std::lock_guard lock(workers[index]->mutex);
+            workers[index]->queues[priority].push_back({std::move(task), std::move(token)});
+        }
+        {
+            std::lock_guard lock(sleep_mutex);
+            pending++;
+        }
+        wake.notify_one();
     }
 
-    [[nodiscard]]
-    bool valid() const override
+    // Runs `f(i)` for all `i` < `count` on the pool, the calling thread helps out and returns when all are done.
+    void parallel_for(size_t count, JobPriority priority, const std::function<void(size_t)> &f)
     {
-        return (bool)texture && !deleted;
+        // Shared, the last task may still notify when the caller has already returned
+        auto remaining = std::make_shared<std::atomic<size_t>>(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            submit([&f, remaining, i]
+            {
+                f(i);
+                if (--*remaining == 0) remaining->notify_all();
+            }, priority);
+        }
+
+        Job job;
+        while (remaining->load() > 0)
+        {
+            if (take(current_worker, job))
+            {
+                run_job(job);
+                continue;
+            }
+            size_t left = remaining->load();
+            if (left > 0) remaining->wait(left);
+        }
     }
 
-    [[nodiscard]]
-    bool hit_test(SDL_FPoint pt) const override
+    // Queues `task` to run on the main thread
+    void run_on_main(Task task)
     {
-        if (!valid()) return false;
-
-        SDL_FRect rc = {
-            (float)pos.x - (float)extent.x * scale,
-            (float)pos.y - (float)extent.y * scale,
-            (float)extent.w * scale,
-            (float)extent.h * scale
-        };
-        if (rotate != 0.0)
+        bool was_empty;
         {
-            rotate_point(pos, &pt, -rotate);
+            std::lock_guard lock(main_mutex);
+            was_empty = continuations.empty();
+            continuations.push_back(std::move(task));
         }
-        if (SDL_PointInRectFloat(&pt, &rc))
+        if (was_empty && main_event)
         {
-            Uint8 alpha;
-            int xoff = (int)((pt.x - rc.x) / scale);
-            int yoff = (int)((pt.y - rc.y) / scale);
-            if (flip_horizontal)
-            {
-                xoff = extent.w - xoff - 1;
-            }
-            if (SDL_ReadSurfacePixel(surface, xoff, yoff, nullptr, nullptr, nullptr, &alpha))
-            {
-                return alpha > 50;
-            }
+            SDL_Event event = {};
+            event.type = main_event;
+            SDL_PushEvent(&event);
         }
+    }
 
-        return false;
+    // Runs the pending continuations (main thread), true if there were any
+    bool run_continuations()
+    {
+        vector<Task> tasks;
+        {
+            std::lock_guard lock(main_mutex);
+            tasks.swap(continuations);
+        }
+        for (Task &task : tasks)
+        {
+            task();
+        }
+        return !tasks.empty();
     }
 
-    bool handle_event(const SDL_Event* event, int &needs_update, AppContext *app) override
+private:
+    struct Job
     {
-        if (!app->layout_mode || !valid()) return false;
+        Task task;
+        CancelToken token;
+    };
 
-        if (event->type == SDL_EVENT_MOUSE_WHEEL)
-        {
-            SDL_FPoint pt(event->wheel.mouse_x, event->wheel.mouse_y);
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Job> queues[JOB_PRIORITIES];
+    };
 
-            if (hit_test(pt))
+    vector<std::unique_ptr<Worker>> workers;
+    vector<std::thread> threads;
+    std::atomic<unsigned> next_worker = 0;
+
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    int pending = 0;  // Queued tasks (guarded by `sleep_mutex`)
+    bool stopping = false;
+
+    std::mutex main_mutex;
+    vector<Task> continuations;
+
+    inline static thread_local int current_worker = -1;
+
+    // Pops a task: own deque from the back, other deques from the front (`self` < 0: steal only)
+    bool take(int self, Job &job)
+    {
+        int count = (int)workers.size();
+        for (int priority = 0; priority < JOB_PRIORITIES; priority++)
+        {
+            for (int k = 0; k < count; k++)
             {
-                if (SDL_GetModState() & SDL_KMOD_CTRL)
-                {
-                    // Rotate image (when ctrl is pressed)
-                    SDL_FPoint ct(pt.x, pt.y);
-                    double phi_delta = 5 * (event->wheel.y < 0 ? -1 : 1);
-                    rotate_point(ct, &pos, phi_delta);
-                    rotate += (float) phi_delta;
-                }
-                else if (SDL_GetModState() & SDL_KMOD_SHIFT)
+                int index = self >= 0 ? (self + k) % count : k;
+                Worker &worker = *workers[index];
+                std::lock_guard lock(worker.mutex);
+                std::deque<Job> &queue = worker.queues[priority];
+                if (queue.empty()) continue;
+
+                if (index == self)
                 {
-                    // Scale image
-                    float dScale = powf(1.1f, event->wheel.y);
-                    scale *= dScale;
-                    pos.x += (float) ((pos.x - pt.x) * (dScale - 1.0));
-                    pos.y += (float) ((pos.y - pt.y) * (dScale - 1.0));
+                    job = std::move(queue.back());
+                    queue.pop_back();
                 }
                 else
                 {
-                    // Change text alpha
-                    if (event->wheel.y < 0)
-                    {
-                        alpha = SDL_max(0.f, alpha - (5.f / 255.f));
-                    }
-                    else
-                    {
-                        alpha = SDL_min(1.f, alpha + (5.f / 255.f));
-                    }
+                    job = std::move(queue.front());
+                    queue.pop_front();
                 }
-                needs_update = UPDATE_SETTINGS_CHANGED;
+                std::lock_guard sleep_lock(sleep_mutex);
+                pending--;
                 return true;
             }
         }
+        return false;
+    }
 
-        else if (event->type == SDL_EVENT_MOUSE_BUTTON_DOWN)
-        {
-            SDL_FPoint pt(event->motion.x, event->motion.y);
-
-            if (hit_test(pt))
-            {
-                app->mouse_capture = this;
-                app->dragging_origin = pt;
-                app->dragging_offset = SDL_FPoint(
-                    pt.x - pos.x,
-                    pt.y - pos.y
-                );
-                return true;
-            }
-        }
+    static void run_job(Job &job)
+    {
+        if (!is_cancelled(job.token)) job.task();
+        job = {};
+    }
 
-        else if (event->type == SDL_EVENT_MOUSE_BUTTON_UP)
+    void run(int self)
+    {
+        current_worker = self;
+        Job job;
+        for (;;)
         {
-            if (app->mouse_capture == this)
+            if (take(self, job))
             {
-                pos = app->dragging_origin;
-                pos.x -= app->dragging_offset.x;
-                pos.y -= app->dragging_offset.y;
-                app->mouse_capture = nullptr;
-                app->dragging_offset = {0};
-                needs_update = UPDATE_SETTINGS_CHANGED;
-                return true;
+                run_job(job);
+                continue;
             }
+
+            // (Stopping waits for the queues to drain, see stop())
+            std::unique_lock lock(sleep_mutex);
+            wake.wait(lock, [this] { return stopping || pending > 0; });
+            if (stopping && pending <= 0) break;
         }
+        current_worker = -1;
+    }
+};
 
-        else if (event->type == SDL_EVENT_MOUSE_MOTION)
-        {
-            SDL_FPoint pt(event->motion.x, event->motion.y);
+JobSystem job_system;
 
-            if (app->mouse_capture == this)
-            {
-                app->dragging_origin = pt;
-                needs_update = UPDATE_VIEW_CHANGED;
-                return true;
-            }
-            else
-            {
-                if (!app->mouse_capture && hit_test(pt))
-                {
-                    SDL_SetCursor(app->handCursor);
-                    return true;
-                }
-            }
-        }
 
-        else if (event->type == SDL_EVENT_KEY_DOWN)
-        {
-            if (event->key.key == SDLK_F)
-            {
-                if (hit_test_at_cursor())
-                {
-                    flip_horizontal = !flip_horizontal;
-                    needs_update = UPDATE_SETTINGS_CHANGED;
-                    return true;
-                }
-            }
-            else if (event->key.key == SDLK_DELETE)
-            {
-                if (hit_test_at_cursor())
-                {
-                    deleted = true;
-                    needs_update = UPDATE_SETTINGS_CHANGED;
-                    return true;
-                }
-            }
-        }
+// Input-to-present latencies of one event type, in logarithmic buckets (20% apart, from 0.1 ms up to ~10 s)
+class LatencyHistogram
+{
+public:
+    static constexpr int bucket_count = 64;
 
-        return false;
+    Uint64 counts[bucket_count] = {};
+    Uint64 count = 0;
+    double sum_ms = 0.0;
+    double max_ms = 0.0;
+
+    // Upper bound of bucket `i`
+    static double bucket_ms(int i)
+    {
+        return 0.1 * pow(1.2, i);
     }
 
-    void draw(const SDL_FPoint &pt, float alpha, const SDL_Renderer *renderer) const override
+    void add(double ms)
     {
-        if (!valid() || !renderer || renderer != this->renderer) return;
+        int i = 0;
+        while (i < bucket_count - 1 && ms > bucket_ms(i)) i++;
+        counts[i]++;
+        count++;
+        sum_ms += ms;
+        max_ms = SDL_max(max_ms, ms);
+    }
 
-        float x = pt.x - (float)extent.x;
-        float y = pt.y - (float)extent.y;
-        float w = (float)extent.w;
-        float h = (float)extent.h;
+    // Upper bound of the bucket holding the `p` quantile (0..1)
+    [[nodiscard]]
+    double percentile_ms(double p) const
+    {
+        if (count == 0) return 0.0;
 
-        render_transformed_texture(
-                texture,
-                x, y, w, h,
-                scale, rotate,
-                flip_horizontal, false,
-                BLENDED_ALPHA_FLOAT(this->alpha, alpha),
-                renderer);
+        auto rank = (Uint64)ceil(p * (double)count);
+        Uint64 seen = 0;
+        for (int i = 0; i < bucket_count; i++)
+        {
+            seen += counts[i];
+            if (seen >= SDL_max(rank, (Uint64)1)) return SDL_min(bucket_ms(i), max_ms);
+        }
+        return max_ms;
     }
 
+    [[nodiscard]]
+    json to_json() const
+    {
+        json buckets = json::array();
+        for (int i = 0; i < bucket_count; i++)
+        {
+            if (counts[i]) buckets.push_back({round_to_precision(bucket_ms(i), 3), counts[i]});
+        }
+        return {
+            {"count", count},
+            {"mean_ms", round_to_precision(count ? sum_ms / (double)count : 0.0, 3)},
+            {"p50_ms", round_to_precision(percentile_ms(0.5), 3)},
+            {"p95_ms", round_to_precision(percentile_ms(0.95), 3)},
+            {"p99_ms", round_to_precision(percentile_ms(0.99), 3)},
+            {"max_ms", round_to_precision(max_ms, 3)},
+            {"buckets", buckets}  // [upper bound in ms, count]
+        };
+    }
 };
 
 
-class AnimatedGif : public Image
+// Time spent in each startup phase and in the creation of each scene object (for `--startup-report`)
+class StartupProfile
 {
-    struct frame_info_t {
-        int delay_ms;
-        int transparent_color_index;
-        int disposal_mode;
-        bool texture_outdated;
-        SDL_Texture *texture;
+public:
+    struct Entry
+    {
+        string name;
+        double ms;
+        Uint32 id = 0;  // Scene object id (objects only)
+    };
+
+    vector<Entry> phases;
+    vector<Entry> objects;
+
+    void begin()
+    {
+        start = last = SDL_GetPerformanceCounter();
+    }
+
+    // Ends the phase running since the previous one
+    void phase(const char *name)
+    {
+        Uint64 now = SDL_GetPerformanceCounter();
+        phases.push_back({name, ms(last, now)});
+        last = now;
+    }
+
+    // Ends the creation of object `id` started at `since` (only call it for objects that were created)
+    void object(Uint32 id, const string &name, Uint64 since)
+    {
+        objects.push_back({name, ms(since, SDL_GetPerformanceCounter()), id});
+    }
+
+    [[nodiscard]]
+    double total_ms() const
+    {
+        return ms(start, last);
+    }
+
+    static double ms(Uint64 from, Uint64 to)
+    {
+        return (double)(to - from) * 1e3 / (double)SDL_GetPerformanceFrequency();
+    }
+
+    static json to_json(const vector<Entry> &entries)
+    {
+        json j = json::array();
+        for (const Entry &entry : entries)
+        {
+            j.push_back({{"name", entry.name}, {"ms", round_to_precision(entry.ms, 2)}});
+        }
+        return j;
+    }
+
+private:
+    Uint64 start = 0;
+    Uint64 last = 0;
+};
+
+
+// Event-to-photon latency: input events that cause a redraw are kept with their arrival timestamp until
+// the render thread has returned from SDL_RenderPresent() on all windows for the first snapshot showing them.
+// (Event timestamps and SDL_GetTicksNS() share one clock)
+class LatencyStats
+{
+    struct Pending
+    {
+        const char *type;
+        Uint64 arrival_ns;
+        Uint64 serial;  // Snapshot showing the event (0: not published yet)
     };
 
+    vector<Pending> pending;
+
 public:
-    bool cache_frames;
-    int frame_count;
-    int current_frame;
-    int recent_disposal;
-    Uint64 latest_ticks;
-    SDL_Rect previous_frame_rect;
-    vector<frame_info_t> frame_info;
-    GifFileType *gif;
+    std::map<string, LatencyHistogram> histograms;
+    mutable std::mutex mutex;  // The main thread adds events, the render thread presents them
 
-    AnimatedGif(
-        float x, float y,
-        const string &name,
-        const path &base_path,
-        float scale_by,
-        float rotate_by,
-        bool flip_horizontal,
-        float alpha,
-        bool cache_frames,
-        const SDL_Renderer *renderer)
-    : Image(x, y, renderer),
-      gif((GifFileType*)nullptr)
+    void input(const char *type, Uint64 arrival_ns)
+    {
+        std::lock_guard lock(mutex);
+        pending.push_back({type, arrival_ns, 0});
+    }
+
+    // The events so far are shown by snapshot `serial` (main thread)
+    void published(Uint64 serial)
+    {
+        std::lock_guard lock(mutex);
+        for (Pending &p : pending)
+        {
+            if (!p.serial) p.serial = serial;
+        }
+    }
+
+    // Snapshot `serial` is on screen (render thread)
+    void presented(Uint64 serial, Uint64 now_ns)
+    {
+        std::lock_guard lock(mutex);
+        std::erase_if(pending, [&](const Pending &p)
+        {
+            if (!p.serial || p.serial > serial) return false;
+            histograms[p.type].add((double)(now_ns - SDL_min(now_ns, p.arrival_ns)) / 1e6);
+            return true;
+        });
+    }
+
+    [[nodiscard]]
+    json to_json() const
+    {
+        std::lock_guard lock(mutex);
+        json j = json::object();
+        for (const auto &[type, histogram] : histograms)
+        {
+            j[type] = histogram.to_json();
+        }
+        return j;
+    }
+};
+
+
+// One transparent overlay window per covered display.
+// The scene uses the coordinates of the primary window, `area` is the window's region in these coordinates.
+struct OverlayWindow
+{
+    SDL_Window *window = nullptr;
+    SDL_WindowID window_id = 0;
+    SDL_Renderer *renderer = nullptr;
+    HWND hwnd = nullptr;
+    SDL_Rect area = {0, 0, 0, 0};
+    float pixel_scale = 1.f;  // Backbuffer pixels per window coordinate (depends on the display)
+    SDL_Texture *drag_background = nullptr;  // The scene without the dragged object (while dragging)
+    Uint64 drag_background_version = 0;      // Scene version it shows
+};
+
+
+struct AppContext
+{
+    path base_path;
+    SDL_Window *window = nullptr;
+    SDL_Renderer *renderer = nullptr;
+    SDL_AppResult app_quit = SDL_APP_CONTINUE;
+    SDL_Cursor *handCursor = nullptr;
+    Uint64 idle_ticks = 0;
+
+    HWND hwnd = nullptr;
+    vector<OverlayWindow> overlays;  // overlays[0] is the primary window (`window`, `renderer`, `hwnd`)
+    bool all_displays = true;  // Open an overlay on every display
+    SDL_Rect screen_rect_init = {-1, -1, -1, -1};  // To initialize `screen_rect` (editable in settimgs file)
+    SDL_Rect screen_rect = {0, 0, 800, 600};  // To initialize `lines_area`
+    SDL_Rect work_area = {0};  // Physical position of the primary overlay window
+    int crop_bottom = 0;  // Crops work_area
+    float center_x = 400, center_y = 300;
+
+    bool hidden = false;
+    float alpha = 0.55f;
+    bool layout_mode = false;
+    bool is_virgin = true;
+    int idle_delay_ms = 600;
+    int timer_slack_ms = 4;  // Deadlines this close to a due one are served in the same wakeup
+    bool needs_redraw = true;
+    bool drag_moved = false;  // Only the dragged object has moved since the last draw
+    Uint64 scene_version = 0;  // Counts the redraws, drag moves don't change it
+    Uint64 frame_serial = 0;   // Of the latest published scene snapshot
+    int wheel_net_steps = 0;  // Steps of the current wheel event, summed over the events merged into it
+    QuadBatch batch;  // Reused each frame (keeps its buffers)
+
+    // Mouse capturing and dragging (screen objects)
+    SceneStore *scene = nullptr;
+    ObjectHandle mouse_capture;
+    SDL_FPoint dragging_origin = {0}, dragging_offset = {0};
+
+    // Text (initial) properties
+    string text_file_name = "signature.txt";
+    string text_content;
+    string text_font_name = "Freeman-Regular.TTF";
+    int text_font_size = 78;
+    COLORREF text_font_color = RGB(112, 146, 190);
+    float text_scale = 0.4f;
+    float text_rotate = 0.f;
+    float text_alpha = 1.f;
+
+    // Logo (initial) properties
+    string logo_file_name = "dragon.png";
+    float logo_scale = 0.2f;
+    float logo_alpha = 1.f;
+
+    // Animated GIF
+    bool have_animations = false;
+
+    // Renderer backend
+    string render_driver;  // Override (settings file), empty or "auto" selects by calibration
+    json render_calibration = json::object();  // Cached calibration result (per machine)
+
+    // Input latency (settings file), shown in layout mode and written to "dragon.latency.json" on exit
+    bool latency_stats = false;
+    LatencyStats latency;
+
+    // Benchmark mode (command line), compares to or records the baseline in `benchmark_file`
+    string benchmark_file;
+    bool benchmark_record = false;
+
+    // Startup profile, reported and exited before the windows are shown with `--startup-report`
+    StartupProfile startup;
+    bool startup_report = false;
+};
+
+
+// Base of all scene components.
+// Transforms (position, scale, rotation, alpha, flip, extent) live in the scene store's arrays,
+// the component only keeps its content (textures, surfaces, decoder state).
+// There is no virtual dispatch: the scene store switches on the type tag.
+class ScreenObject
+{
+public:
+    SceneTransforms *tf;
+    Uint32 slot;
+
+    // Desktop position of the scene's origin (the primary overlay window)
+    static inline SDL_FPoint scene_origin = {0, 0};
+
+    ScreenObject(SceneTransforms *tf, Uint32 slot, float x, float y)
+    : tf(tf),
+      slot(slot)
+    {
+        set_pos({x, y});
+    };
+
+    ScreenObject(const ScreenObject &) = delete;
+    ScreenObject &operator=(const ScreenObject &) = delete;
+
+    [[nodiscard]] ObjectHandle handle() const { return {tf->id[slot], tf->type[slot], slot}; }
+    [[nodiscard]] SDL_FPoint pos() const { return {tf->x[slot], tf->y[slot]}; }
+    void set_pos(SDL_FPoint pt) { tf->x[slot] = pt.x; tf->y[slot] = pt.y; }
+    [[nodiscard]] float &scale() const { return tf->scale[slot]; }
+    [[nodiscard]] float &rotate() const { return tf->rotate[slot]; }
+    [[nodiscard]] float &alpha() const { return tf->alpha[slot]; }
+    [[nodiscard]] Uint8 &flip() const { return tf->flip[slot]; }
+    [[nodiscard]] Uint8 &deleted() const { return tf->deleted[slot]; }
+    [[nodiscard]] SDL_Rect &extent() const { return tf->extent[slot]; }
+
+    [[nodiscard]]
+    static SDL_FPoint cursor_position()
+    {
+        SDL_FPoint pt;
+
+        SDL_GetGlobalMouseState(&pt.x, &pt.y);
+        pt.x -= scene_origin.x;
+        pt.y -= scene_origin.y;
+
+        return pt;
+    }
+
+    static void rotate_point(SDL_FPoint ct, SDL_FPoint* pt, double phi_deg)
+    {
+        double phi = phi_deg * M_PI / 180;
+        double dx = pt->x - ct.x;
+        double dy = pt->y - ct.y;
+        double cphi = cos(phi);
+        double sphi = sin(phi);
+
+        pt->x = (float)((double)ct.x + dx * cphi - dy * sphi);
+        pt->y = (float)((double)ct.y + dx * sphi + dy * cphi);
+    }
+};
+
+
+// Lock-free handoff of the latest value from one writer thread to one reader thread.
+// Both sides own a slot, the third one is exchanged: the writer never waits for the reader,
+// and the reader always gets the most recently published value.
+template <typename T>
+class TripleBuffer
+{
+    static constexpr int fresh = 4;  // Flags an exchanged slot that the reader hasn't taken yet
+
+    T slots[3];
+    int back = 0;
+    std::atomic<int> middle = 1;
+    int front = 2;
+
+public:
+    // Writer side
+    T &write_buffer() { return slots[back]; }
+
+    void publish()
+    {
+        back = middle.exchange(back | fresh) & 3;
+    }
+
+    // Reader side, false if nothing was published since the last update
+    bool update()
+    {
+        if (!(middle.load() & fresh)) return false;
+        front = middle.exchange(front) & 3;
+        return true;
+    }
+
+    const T &read_buffer() const { return slots[front]; }
+};
+
+
+class LineObject : public ScreenObject
+{
+
+public:
+    int width;
+    COLORREF color;
+    bool dashed;
+    int dashed_len;
+    int dashed_gap;
+    float line_angle;
+    float line_spacing;
+    bool raster_thread = true;  // Spread re-rasters over frames (the first raster of a window is done in one go)
+    const Uint64 &idle_ticks;
+
+    LineObject(
+        SceneTransforms *tf,
+        Uint32 slot,
+        const Uint64 &idle_ticks,
+        int width = 1,
+        COLORREF color = 0,
+        bool dashed = true,
+        int dash_len = 10,
+        int dash_gap = 10,
+        float line_angle = 45.f,
+        float line_spacing = 15.f)
+        : ScreenObject(tf, slot, 0, 0),
+        width(width),
+        color(color),
+        dashed(dashed),
+        dashed_len(dash_len),
+        dashed_gap(dash_gap),
+        line_angle(line_angle),
+        line_spacing(line_spacing),
+        idle_ticks(idle_ticks)
+        {}
+
+    ~LineObject()
+    {
+        for (auto &[renderer, layer] : layers)
+        {
+            release_chunks(layer);
+        }
+        for (SDL_Surface *surface : scratch)
+        {
+            SDL_DestroySurface(surface);
+        }
+    }
+
+    // Settings the line layer is drawn with, copied into each scene snapshot
+    struct Style
+    {
+        int width;
+        COLORREF color;
+        bool dashed;
+        int dashed_len;
+        int dashed_gap;
+        float line_angle;
+        float line_spacing;
+        bool raster_thread;
+        Uint64 seed;  // Of the dash pattern (the idle ticks)
+    };
+
+    [[nodiscard]]
+    Style style() const
+    {
+        return {width, color, dashed, dashed_len, dashed_gap, line_angle, line_spacing, raster_thread, idle_ticks};
+    }
+
+    [[nodiscard]]
+    const char* type_name() const { return "Lines"; }
+
+    [[nodiscard]]
+    json to_json() const {
+        return json{
+            {"type", type_name()},
+            {"id", tf->id[slot]},
+            {"alpha", 1.f},
+            {"width", width},
+            {"color", int_to_hex_color(color)},
+            {"dashed", dashed},
+            {"dashed_len", dashed_len},
+            {"dashed_gap", dashed_gap},
+            {"line_angle", round_to_precision(line_angle, 4)},
+            {"line_spacing", round_to_precision(line_spacing, 1)},
+            {"raster_thread", raster_thread}
+        };
+    }
+
+    [[nodiscard]]
+    bool valid() const { return true; }
+
+    [[nodiscard]]
+    bool hit_test([[maybe_unused]] SDL_FPoint pt) const {
+        // The line object is not selectable
+        return false;
+    }
+
+    bool handle_event(const SDL_Event* event, int& needs_update, AppContext* app) {
+        if (!app->layout_mode) return false;
+
+        if (event->type == SDL_EVENT_MOUSE_WHEEL)
+        {
+            if (SDL_GetModState() & SDL_KMOD_SHIFT)
+            {
+                // Adjust spacing
+                int steps = app->wheel_net_steps;
+                line_spacing *= powf((steps > 0) ? 1.1f : 0.9f, (float)SDL_abs(steps));
+                line_spacing = SDL_max(2.f, line_spacing);
+                line_spacing = SDL_min(50.f, line_spacing);
+                needs_update = UPDATE_SETTINGS_CHANGED;
+                app->is_virgin = false;
+                return true;
+            }
+            else if (SDL_GetModState() & SDL_KMOD_CTRL)
+            {
+                // Adjust orientation
+                float angle_delta = 5.f * (float)app->wheel_net_steps; // degrees
+                line_angle += angle_delta;
+                needs_update = UPDATE_SETTINGS_CHANGED;
+                app->is_virgin = false;
+                return true;
+            }
+        }
+        else if (event->type == SDL_EVENT_KEY_DOWN)
+        {
+            COLORREF c;
+            if (color_from_key((int)event->key.key, c))
+            {
+                this->color = c;
+                needs_update = UPDATE_SETTINGS_CHANGED;
+                app->is_virgin = false;
+                return true;
+            }
+            else if (event->key.key >= SDLK_0 && event->key.key <= SDLK_5)
+            {
+                this->width = (int)(event->key.key - SDLK_0);
+                needs_update = UPDATE_SETTINGS_CHANGED;
+                app->is_virgin = false;
+                return true;
+            }
+            else if (event->key.key == SDLK_D)
+            {
+                this->dashed = !this->dashed;
+                needs_update = UPDATE_SETTINGS_CHANGED;
+                app->is_virgin = false;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Draws the lines with `style` (of the snapshot drawn, the render thread doesn't read the settings above)
+    void draw(const Style &style, float global_alpha, const OverlayWindow &overlay, QuadBatch &batch) const
+    {
+        const SDL_Renderer *renderer = overlay.renderer;
+
+        if (style.width == 0) return;
+        if (!valid() || !renderer) return;
+
+        // Lines are drawn directly, submit everything queued before
+        batch.flush(renderer);
+
+        if (style.width > 1 && !style.dashed)
+        {
+            SDL_Color rgba = {
+                GetRValue(style.color),
+                GetGValue(style.color),
+                GetBValue(style.color),
+                SDL_min((Uint8)255, (Uint8)(global_alpha * 255.f))
+            };
+            // (premultiplied)
+            SDL_FColor frgba = {
+                rgba.r / 255.f * rgba.a / 255.f,
+                rgba.g / 255.f * rgba.a / 255.f,
+                rgba.b / 255.f * rgba.a / 255.f,
+                rgba.a / 255.f
+            };
+
+            // All lines are submitted with one geometry call
+            vector<SDL_Vertex> verts;
+            vector<int> indices;
+
+            int gap_len = style.dashed ? style.dashed_gap : 0;
+
+            for_each_line(overlay.area.w, overlay.area.h, style.line_angle, style.line_spacing, style.dashed_len, gap_len, nullptr, [&](SDL_Point p1, SDL_Point p2, int)
+            {
+                auto dx = (float)(p2.x - p1.x);
+                auto dy = (float)(p2.y - p1.y);
+                float len = sqrtf(dx*dx + dy*dy);
+                if (len == 0) return;
+                float nx = -dy / len;
+                float ny = dx / len;
+                float w = (float)style.width / 2.f;
+
+                int base = (int)verts.size();
+                verts.push_back({{ (float)p1.x + nx * w, (float)p1.y + ny * w }, frgba, { 0, 0 }});
+                verts.push_back({{ (float)p1.x - nx * w, (float)p1.y - ny * w }, frgba, { 0, 0 }});
+                verts.push_back({{ (float)p2.x + nx * w, (float)p2.y + ny * w }, frgba, { 0, 0 }});
+                verts.push_back({{ (float)p2.x - nx * w, (float)p2.y - ny * w }, frgba, { 0, 0 }});
+
+                int quad_indices[] = { base, base + 1, base + 2, base + 1, base + 3, base + 2 };
+                indices.insert(indices.end(), quad_indices, quad_indices + 6);
+            });
+
+            if (!verts.empty())
+            {
+                // Untextured geometry blends with the draw blend mode
+                SDL_SetRenderDrawBlendMode(const_cast<SDL_Renderer *>(renderer), SDL_BLENDMODE_BLEND_PREMULTIPLIED);
+                SDL_RenderGeometry(
+                    const_cast<SDL_Renderer *>(renderer),
+                    nullptr,
+                    verts.data(),
+                    (int)verts.size(),
+                    indices.data(),
+                    (int)indices.size());
+                SDL_SetRenderDrawBlendMode(const_cast<SDL_Renderer *>(renderer), SDL_BLENDMODE_BLEND);
+            }
+        }
+        else
+        {
+            const LineLayer &layer = update_chunks(style, global_alpha, overlay);
+
+            // Chunks are in backbuffer pixels, map them 1:1
+            float s = 1.f / layer.pixel_scale;
+            for (const LineChunk &chunk : layer.chunks)
+            {
+                if (!chunk.texture || chunk.empty) continue;
+                SDL_FRect rect = {
+                    (float)chunk.rect.x * s, (float)chunk.rect.y * s,
+                    (float)chunk.rect.w * s, (float)chunk.rect.h * s
+                };
+                SDL_RenderTexture(const_cast<SDL_Renderer *>(renderer), chunk.texture, nullptr, &rect);
+            }
+        }
+    }
+
+    // Tells (once) if a re-raster advanced without completing in the last frames, so another frame is due
+    [[nodiscard]]
+    bool raster_progressed() const
+    {
+        return std::exchange(progressed, false);
+    }
+
+private:
+    // Edge length of the line layer chunks in pixels.
+    // The layer is kept as a grid of chunk textures, so no surface spans the whole work area.
+    static constexpr int chunk_size = 512;
+
+    // Time a frame spends on a re-raster (at least one batch of chunks is done per frame)
+    static constexpr Uint64 raster_budget_ms = 4;
+
+    struct LineChunk
+    {
+        SDL_Rect rect;          // Covered region of the backbuffer
+        SDL_Texture *texture;   // Shown, created on first use and reused afterwards
+        bool empty;             // No line pixel falls into the chunk
+        SDL_Texture *next;      // Back buffer of a re-raster, swapped with `texture` when the raster is complete
+        bool next_empty;
+    };
+
+    // One rasterized line (lines wider than 1 pixel consist of several)
+    struct LineSegment
+    {
+        int x1, y1, dx, dy;
+        int dash_offset;
+        SDL_Rect bounds;
+    };
+
+    // Everything the rasterized layer depends on, lengths in backbuffer pixels
+    struct RasterParams
+    {
+        int width;
+        COLORREF color;
+        bool dashed;
+        int dash_len;
+        int gap_len;  // 0 for solid lines
+        float line_angle;
+        float line_spacing;
+        Uint64 seed;
+        Uint8 alpha;
+        int wa_width;
+        int wa_height;
+
+        bool operator==(const RasterParams &) const = default;
+    };
+
+    // Rasterized line layer of one overlay window
+    struct LineLayer
+    {
+        vector<LineChunk> chunks;
+        RasterParams params = {};  // Of the shown raster
+        float pixel_scale = 1.f;
+        bool valid = false;
+        bool rastering = false;    // A re-raster with `next` is in progress
+        RasterParams next = {};
+        size_t progress = 0;       // Chunks of the re-raster done
+    };
+
+    // Line settings scaled to a `wa_width` x `wa_height` backbuffer with `pixel_scale` pixels per window coordinate
+    [[nodiscard]]
+    static RasterParams raster_params(const Style &style, float global_alpha, int wa_width, int wa_height, float pixel_scale)
+    {
+        return {
+            SDL_max(1, (int)lroundf((float)style.width * pixel_scale)),
+            style.color,
+            style.dashed,
+            SDL_max(1, (int)lroundf((float)style.dashed_len * pixel_scale)),
+            style.dashed ? SDL_max(0, (int)lroundf((float)style.dashed_gap * pixel_scale)) : 0,
+            style.line_angle,
+            style.line_spacing * pixel_scale,
+            style.dashed ? style.seed : 0,
+            SDL_min((Uint8)255, (Uint8)(global_alpha * 255.f)),
+            wa_width,
+            wa_height
+        };
+    }
+
+    // Pixel value of the raster in the pixel format (premultiplied)
+    [[nodiscard]]
+    static Uint32 raster_pixel(const RasterParams &params)
+    {
+        return SDL_MapRGBA(
+                SDL_GetPixelFormatDetails(asset_cache.pixel_format),
+                nullptr,
+                (Uint8)(GetRValue(params.color) * params.alpha / 255),
+                (Uint8)(GetGValue(params.color) * params.alpha / 255),
+                (Uint8)(GetBValue(params.color) * params.alpha / 255),
+                params.alpha);
+    }
+
+    // Calls `f(p1, p2, dash_offset)` for each line with its intersections on the boundary of a
+    // `wa_width` x `wa_height` area. Dash offsets are drawn from `rng` (0 without).
+    template <typename F>
+    static void for_each_line(
+            int wa_width, int wa_height,
+            float angle, float spacing, int dash_len, int gap_len,
+            std::mt19937 *rng,
+            F &&f)
+    {
+        float angle_rad = angle * (float)M_PI / 180.f;
+        float sa = sinf(angle_rad);
+        float ca = cosf(angle_rad);
+
+        // Line equation: -sa*x + ca*y = C
+        float c00 = 0;
+        float c10 = -sa * (float)wa_width;
+        float c01 = ca * (float)wa_height;
+        float c11 = -sa * (float)wa_width + ca * (float)wa_height;
+        float c_min = (std::min)({c00, c10, c01, c11});
+        float c_max = (std::max)({c00, c10, c01, c11});
+
+        for (float c = c_min; c < c_max; c += spacing)
+        {
+            int dash_offset = rng ? std::uniform_int_distribution<int>(0, dash_len + gap_len - 1)(*rng) : 0;
+
+            // find intersections with screen boundaries
+            vector<SDL_Point> intersections;
+
+            if (sa != 0)
+            {
+                float x = -c / sa;
+                if (x >= 0 && x <= (float)wa_width) intersections.push_back({(int)x, 0});
+            }
+            if (sa != 0)
+            {
+                float x = ((float)wa_height * ca - c) / sa;
+                if (x >= 0 && x <= (float)wa_width) intersections.push_back({(int)x, wa_height});
+            }
+            if (ca != 0)
+            {
+                float y = c / ca;
+                if (y >= 0 && y <= (float)wa_height) intersections.push_back({0, (int)y});
+            }
+            if (ca != 0)
+            {
+                float y = (c + (float)wa_width * sa) / ca;
+                if (y >= 0 && y <= (float)wa_height) intersections.push_back({wa_width, (int)y});
+            }
+
+            if (intersections.size() >= 2)
+            {
+                std::sort(
+                        intersections.begin(),
+                        intersections.end(),
+                        [](const SDL_Point& a, const SDL_Point& b)
+                        {
+                            if (a.x != b.x) return a.x < b.x;
+                            return a.y < b.y;
+                        }
+                );
+                intersections.erase(
+                        std::unique(
+                                intersections.begin(),
+                                intersections.end(),
+                                [](const SDL_Point& a, const SDL_Point& b)
+                                {
+                                    return a.x == b.x && a.y == b.y;
+                                }
+                        ),
+                        intersections.end());
+
+                if (intersections.size() >= 2)
+                {
+                    f(intersections[0], intersections[1], dash_offset);
+                }
+            }
+        }
+    }
+
+    // Builds the 1 pixel segments of all lines, the dash pattern is seeded with the idle ticks.
+    // (Depends on `params` only, so it runs on any thread)
+    static void build_segments(const RasterParams &params, vector<LineSegment> &segments)
+    {
+        int quarter_dash_len = (params.dash_len + 2) / 4;
+        std::mt19937 rng((unsigned)params.seed);
+        segments.clear();
+
+        for_each_line(
+            params.wa_width, params.wa_height,
+            params.line_angle, params.line_spacing, params.dash_len, params.gap_len,
+            params.dashed ? &rng : nullptr,
+            [&](SDL_Point p1, SDL_Point p2, int dash_offset)
+        {
+            int dx = p2.x - p1.x;
+            int dy = p2.y - p1.y;
+            int jitter = 0;
+            bool horizontal = abs(dx) > abs(dy);
+
+            for (int d = -(params.width - 1) / 2; d <= params.width / 2; d++)
+            {
+                if (params.dashed)
+                {
+                    jitter = std::uniform_int_distribution<int>(0, max(4, quarter_dash_len) - 1)(rng) - quarter_dash_len / 2;
+                }
+                int x1 = horizontal ? p1.x : p1.x + d;
+                int y1 = horizontal ? p1.y + d : p1.y;
+                SDL_Rect bounds = {
+                    SDL_min(x1, x1 + dx), SDL_min(y1, y1 + dy),
+                    SDL_abs(dx) + 1, SDL_abs(dy) + 1
+                };
+                segments.push_back({x1, y1, dx, dy, dash_offset + jitter, bounds});
+            }
+        });
+    }
+
+    // Clears `scratch` and draws the segments crossing `rect` of the layer, returns the number of pixels visited
+    static int rasterize_chunk(
+            const RasterParams &params,
+            const vector<LineSegment> &segments,
+            const SDL_Rect &rect,
+            Uint32 pixel,
+            SDL_Surface *scratch)
+    {
+        int visited = 0;
+
+        SDL_FillSurfaceRect(scratch, nullptr, 0);
+        SDL_LockSurface(scratch);
+        for (const LineSegment &segment : segments)
+        {
+            if (!SDL_HasRectIntersection(&segment.bounds, &rect)) continue;
+            visited += draw_line_bresenham(
+                segment.x1, segment.y1,
+                segment.dx, segment.dy,
+                params.dash_len, params.gap_len, segment.dash_offset,
+                pixel,
+                scratch,
+                rect);
+        }
+        SDL_UnlockSurface(scratch);
+        return visited;
+    }
+
+    // Chunk regions of a `wa_width` x `wa_height` layer, row by row
+    static void chunk_grid(int wa_width, int wa_height, vector<SDL_Rect> &rects)
+    {
+        rects.clear();
+        for (int y = 0; y < wa_height; y += chunk_size)
+        {
+            for (int x = 0; x < wa_width; x += chunk_size)
+            {
+                rects.push_back({x, y, SDL_min(chunk_size, wa_width - x), SDL_min(chunk_size, wa_height - y)});
+            }
+        }
+    }
+
+    mutable std::unordered_map<const SDL_Renderer *, LineLayer> layers;
+    mutable vector<LineSegment> segments;
+    mutable RasterParams segment_params = {};  // `segments` are built for these
+    mutable bool segments_valid = false;
+    mutable vector<SDL_Surface *> scratch;     // Chunk-sized, one per task of a batch
+    mutable bool progressed = false;           // See `raster_progressed()`
+
+    static void release_chunks(LineLayer &layer)
+    {
+        for (LineChunk &chunk : layer.chunks)
+        {
+            if (chunk.texture) SDL_DestroyTexture(chunk.texture);
+            if (chunk.next) SDL_DestroyTexture(chunk.next);
+        }
+        layer.chunks.clear();
+        layer.valid = false;
+        layer.rastering = false;
+    }
+
+    // Takes over `params`, the chunk grid is rebuilt on size changes (a re-raster in progress is dropped)
+    static void prepare_layer(LineLayer &layer, const RasterParams &params, float pixel_scale)
+    {
+        if (!layer.valid || params.wa_width != layer.params.wa_width || params.wa_height != layer.params.wa_height)
+        {
+            vector<SDL_Rect> rects;
+            release_chunks(layer);
+            chunk_grid(params.wa_width, params.wa_height, rects);
+            for (const SDL_Rect &rect : rects)
+            {
+                layer.chunks.push_back({rect, nullptr, true, nullptr, true});
+            }
+        }
+        layer.params = params;
+        layer.pixel_scale = pixel_scale;
+        layer.valid = true;
+        layer.rastering = false;
+    }
+
+    // Uploads chunk `pixels` 1:1 into `texture` of the chunk covering `rect` (created on first use), false on failure
+    static bool upload_chunk(const SDL_Renderer *renderer, const SDL_Rect &rect, SDL_Texture *&texture, const void *pixels, int pitch)
+    {
+        if (!texture)
+        {
+            texture = SDL_CreateTexture(
+                const_cast<SDL_Renderer *>(renderer),
+                asset_cache.pixel_format,
+                SDL_TEXTUREACCESS_STATIC,
+                rect.w, rect.h);
+            if (!texture)
+            {
+                SDL_Log("Failed to create line chunk texture: %s", SDL_GetError());
+                return false;
+            }
+            SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND_PREMULTIPLIED);
+            SDL_SetTextureScaleMode(texture, SDL_SCALEMODE_NEAREST);
+        }
+        return SDL_UpdateTexture(texture, nullptr, pixels, pitch);
+    }
+
+    // Creates the scratch surfaces, one per worker and one for the calling thread (false if there are none)
+    bool prepare_scratch() const
+    {
+        size_t count = (size_t)job_system.worker_count() + 1;
+
+        while (scratch.size() < count)
+        {
+            SDL_Surface *surface = SDL_CreateSurface(chunk_size, chunk_size, asset_cache.pixel_format);
+            if (!surface) break;
+            scratch.push_back(surface);
+        }
+        return !scratch.empty();
+    }
+
+    // Rasterizes `count` (up to one per scratch surface) of `chunks` from `first` on, in parallel on the job system,
+    // then calls `upload(i, empty, surface)` for each of them on the calling thread
+    template <typename F>
+    void rasterize_batch(const RasterParams &params, const vector<LineChunk> &chunks, size_t first, size_t count, F &&upload) const
+    {
+        if (!segments_valid || !(segment_params == params))
+        {
+            build_segments(params, segments);
+            segment_params = params;
+            segments_valid = true;
+        }
+
+        Uint32 pixel = raster_pixel(params);
+        vector<Uint8> empty(count, 1);  // (`vector<bool>` isn't safe for concurrent writes)
+        job_system.parallel_for(count, JOB_INTERACTIVE, [&](size_t i)
+        {
+            empty[i] = rasterize_chunk(params, segments, chunks[first + i].rect, pixel, scratch[i]) == 0;
+        });
+
+        for (size_t i = 0; i < count; i++)
+        {
+            upload(first + i, empty[i] != 0, scratch[i]);
+        }
+    }
+
+    // Brings the chunk grid of the window up to `style`.
+    // The layer is rasterized at backbuffer resolution and drawn 1:1, in batches: each chunk of a batch is cleared
+    // and drawn with the segments crossing it on the job system, into a scratch surface of its own, and uploaded.
+    // So memory is bounded by one chunk-sized surface per worker, whatever the size of the work area.
+    // The first raster of a window (and every raster without `raster_thread`) is made in one go. Re-rasters go to
+    // the back textures of the chunks, a few batches per frame, and are swapped in at once when complete: the window
+    // shows the previous raster until then, and frames (e.g. of a drag) keep coming meanwhile.
+    // Windows with the same backbuffer size and scale (identical monitors) share the raster of each chunk.
+    const LineLayer &update_chunks(const Style &style, float global_alpha, const OverlayWindow &overlay) const
+    {
+        LineLayer &layer = layers[overlay.renderer];
+        RasterParams params = raster_params(
+                style,
+                global_alpha,
+                (int)lroundf((float)overlay.area.w * overlay.pixel_scale),
+                (int)lroundf((float)overlay.area.h * overlay.pixel_scale),
+                overlay.pixel_scale);
+
+        if (layer.valid && params == layer.params)
+        {
+            layer.rastering = false;  // (Changed back before a re-raster was done)
+            return layer;
+        }
+        if (!prepare_scratch()) return layer;
+
+        vector<std::pair<const SDL_Renderer *, LineLayer *>> targets = {{overlay.renderer, &layer}};
+        for (auto &[renderer, other] : layers)
+        {
+            if (&other != &layer && other.valid && other.pixel_scale == overlay.pixel_scale &&
+                other.params.wa_width == params.wa_width && other.params.wa_height == params.wa_height)
+            {
+                targets.emplace_back(renderer, &other);
+            }
+        }
+
+        if (!layer.valid || params.wa_width != layer.params.wa_width || params.wa_height != layer.params.wa_height ||
+            !style.raster_thread)
+        {
+            // In one go, straight into the shown textures
+            for (auto &[renderer, target] : targets)
+            {
+                prepare_layer(*target, params, overlay.pixel_scale);
+            }
+            for (size_t first = 0; first < layer.chunks.size(); first += scratch.size())
+            {
+                size_t count = SDL_min(scratch.size(), layer.chunks.size() - first);
+                rasterize_batch(params, layer.chunks, first, count, [&](size_t i, bool empty, const SDL_Surface *surface)
+                {
+                    for (auto &[renderer, target] : targets)
+                    {
+                        LineChunk &chunk = target->chunks[i];
+                        chunk.empty = empty || !upload_chunk(renderer, chunk.rect, chunk.texture, surface->pixels, surface->pitch);
+                    }
+                });
+            }
+            return layer;
+        }
+
+        if (!layer.rastering || !(layer.next == params))
+        {
+            // A new re-raster starts over in all windows sharing it
+            for (auto &[renderer, target] : targets)
+            {
+                target->rastering = true;
+                target->next = params;
+                target->progress = 0;
+            }
+        }
+        else
+        {
+            // (Windows that have started another re-raster since don't share this one)
+            std::erase_if(targets, [&](const auto &target)
+            {
+                const LineLayer &other = *target.second;
+                return !other.rastering || !(other.next == params) || other.progress != layer.progress;
+            });
+        }
+
+        Uint64 start = SDL_GetTicks();
+        do
+        {
+            size_t first = layer.progress;
+            size_t count = SDL_min(scratch.size(), layer.chunks.size() - first);
+            rasterize_batch(params, layer.chunks, first, count, [&](size_t i, bool empty, const SDL_Surface *surface)
+            {
+                for (auto &[renderer, target] : targets)
+                {
+                    LineChunk &chunk = target->chunks[i];
+                    chunk.next_empty = empty || !upload_chunk(renderer, chunk.rect, chunk.next, surface->pixels, surface->pitch);
+                }
+            });
+            for (auto &[renderer, target] : targets)
+            {
+                target->progress = first + count;
+            }
+        }
+        while (layer.progress < layer.chunks.size() && SDL_GetTicks() - start < raster_budget_ms);
+
+        if (layer.progress < layer.chunks.size())
+        {
+            progressed = true;
+            return layer;
+        }
+
+        // Complete, all chunks change at once (the previous textures are reused by the next re-raster)
+        for (auto &[renderer, target] : targets)
+        {
+            for (LineChunk &chunk : target->chunks)
+            {
+                std::swap(chunk.texture, chunk.next);
+                std::swap(chunk.empty, chunk.next_empty);
+            }
+            target->params = params;
+            target->rastering = false;
+        }
+        return layer;
+    }
+};
+
+class Signature : public ScreenObject
+{
+public:
+    string text;
+
+    string font_name;
+    float font_size;
+    COLORREF font_color;
+    SDL_Surface *surface;
+    Uint32 surface_version = 0;  // Bumped on color changes (the uploads are outdated then)
+
+    Signature(
+        SceneTransforms *tf,
+        Uint32 slot,
+        const string &signature,
+        float x,
+        float y,
+        const string &font_name,
+        float font_size,
+        COLORREF font_color,
+        const path &font_path,
+        float scale_by,
+        float rotate_by,
+        float alpha)
+        : ScreenObject(tf, slot, x, y),
+          surface(nullptr)
+    {
+        init(signature, x, y, font_name, font_size, font_color, font_path, scale_by, rotate_by, alpha);
+    }
+
+    Signature(SceneTransforms *tf, Uint32 slot, json &j, path &font_path)
+    : ScreenObject(tf, slot, -1, -1),
+      surface(nullptr)
+    {
+        try
+        {
+            init(
+                j.value("text", "Example"),
+                j["x"], j["y"],
+                j.value("font_name", "Freeman-Regular.TTF"),
+                j.value("font_size", 80.f),
+                get_color_value(j, "font_color", 0xffffff),
+                font_path,
+                j.value("scale", 1.f),
+                j.value("rotate", 0.f),
+                j.value("alpha", 1.f));
+        }
+        catch (const std::exception &e)
+        {
+            SDL_Log("Error creating signature: %s", e.what());
+        }
+    }
+
+    [[nodiscard]]
+    const char* type_name() const {return "Signature";}
+
+    ~Signature()
+    {
+        asset_cache.forget(this);
+        SDL_DestroySurface(surface);
+        surface = nullptr;
+    }
+
+protected:
+    void init(
+        const string &signature,
+        float x,
+        float y,
+        const string &font_name,
+        float font_size,
+        COLORREF font_color,
+        const path &font_path,
+        float scale_by,
+        float rotate_by,
+        float alpha)
+    {
+        TTF_Font* font = nullptr;
+
+        set_pos({x, y});
+        scale() = scale_by;
+        rotate() = rotate_by;
+        text = signature;
+        this->font_name = font_name;
+        this->font_size = font_size;
+        this->font_color = font_color;
+        this->alpha() = alpha;
+
+        for (;;)
+        {
+            auto font_fullpath = font_path / font_name;
+
+            font = asset_cache.open_font(font_fullpath.string(), font_size);
+            if (!font) break;
+
+            // render the font to a surface
+            // (TTF_RenderText_Blended() creates an ARGB surface)
+            surface = asset_cache.to_native(TTF_RenderText_Blended(
+                font,
+                signature.c_str(), signature.length(),
+                SDL_Color(
+                        GetBValue(font_color),
+                        GetGValue(font_color),
+                        GetRValue(font_color),
+                        (int)(alpha * 255.f))
+            ));
+            if (!surface) break;
+
+            // (Textures are uploaded when first drawn, a text too large for them is dropped here)
+            if (!asset_cache.fits_texture(surface))
+            {
+                SDL_Log("Text \"%s\" is too large for a texture", signature.c_str());
+                SDL_DestroySurface(surface);
+                surface = nullptr;
+                break;
+            }
+
+            // get the on-screen dimensions of the text. this is necessary for rendering it
+            extent() = {.w = surface->w, .h = surface->h};
+            extent().x = extent().w / 2;
+            extent().y = extent().h / 2;
+            break;
+        }
+
+        // we no longer need the font or the surface, so we can destroy those now.
+        asset_cache.close_font(font);
+    }
+
+public:
+    [[nodiscard]]
+    json to_json() const
+    {
+        if (!valid()) return json::object();
+
+        return json( {
+             {"id", tf->id[slot]},
+             {"x", (int)pos().x},
+             {"y", (int)pos().y},
+             {"text", text},
+             {"scale", round_to_precision(scale(), 4)},
+             {"rotate", round_to_precision(rotate(), 4)},
+             {"alpha", round_to_precision(alpha(), 2)},
+             {"font_name", font_name},
+             {"font_size", round_to_precision(font_size, 1)},
+             {"font_color", int_to_hex_color(font_color)},
+             {"type", type_name()}
+        } );
+    }
+
+    [[nodiscard]]
+    bool valid() const
+    {
+        return (bool) surface && !deleted();
+    }
+
+    [[nodiscard]]
+    bool hit_test(SDL_FPoint pt) const
+    {
+        if (!valid()) return false;
+
+        return tf->contains(slot, pt);
+    }
+
+    bool handle_event(const SDL_Event* event, int &needs_update, AppContext *app)
+    {
+        if (!app->layout_mode || !valid()) return false;
+
+        if (event->type == SDL_EVENT_MOUSE_WHEEL)
+        {
+            SDL_FPoint pt(event->wheel.mouse_x, event->wheel.mouse_y);
+
+            if (hit_test(pt))
+            {
+                if (SDL_GetModState() & SDL_KMOD_CTRL)
+                {
+                    // Rotate text (when ctrl is pressed)
+                    SDL_FPoint ct(pt.x, pt.y);
+                    SDL_FPoint p = pos();
+                    double phi_delta = 5 * app->wheel_net_steps;
+                    rotate_point(ct, &p, phi_delta);
+                    set_pos(p);
+                    rotate() += (float) phi_delta;
+                }
+                else if (SDL_GetModState() & SDL_KMOD_SHIFT)
+                {
+                    // Scale text
+                    float dScale = powf(1.1f, event->wheel.y);
+                    SDL_FPoint p = pos();
+                    scale() *= dScale;
+                    p.x += (float) ((p.x - pt.x) * (dScale - 1.0));
+                    p.y += (float) ((p.y - pt.y) * (dScale - 1.0));
+                    set_pos(p);
+                }
+                else
+                {
+                    // Change text alpha
+                    alpha() = SDL_clamp(alpha() + (float)app->wheel_net_steps * (5.f / 255.f), 0.f, 1.f);
+                    needs_update = UPDATE_SETTINGS_CHANGED;
+                    return true;
+                }
+                needs_update = UPDATE_SETTINGS_CHANGED;
+                return true;
+            }
+        }
+
+        else if (event->type == SDL_EVENT_MOUSE_BUTTON_DOWN)
+        {
+            SDL_FPoint pt(event->motion.x, event->motion.y);
+
+            if (hit_test(pt))
+            {
+                // Start mouse capturing (dragging object)
+                app->mouse_capture = handle();
+                app->dragging_origin = pt;
+                app->dragging_offset = SDL_FPoint(
+                    pt.x - pos().x,
+                    pt.y - pos().y
+                );
+                return true;
+            }
+        }
+
+        else if (event->type == SDL_EVENT_MOUSE_BUTTON_UP)
+        {
+            if (app->mouse_capture == handle())
+            {
+                // Stop mouse capturing (dragging object)
+                SDL_FPoint p = app->dragging_origin;
+                p.x -= app->dragging_offset.x;
+                p.y -= app->dragging_offset.y;
+                set_pos(p);
+                app->mouse_capture = {};
+                app->dragging_offset = {0};
+                needs_update = UPDATE_SETTINGS_CHANGED;
+                return true;
+            }
+        }
+
+        else if (event->type == SDL_EVENT_MOUSE_MOTION)
+        {
+            SDL_FPoint pt(event->motion.x, event->motion.y);
+
+            if (app->mouse_capture == handle())
+            {
+                app->dragging_origin = pt;
+                needs_update = UPDATE_VIEW_CHANGED;
+                return true;
+            }
+            else
+            {
+                // Show hand cursor when hovering over object
+                if (!app->mouse_capture && hit_test(pt))
+                {
+                    SDL_SetCursor(app->handCursor);
+                    return true;
+                }
+            }
+        }
+
+        else if (event->type == SDL_EVENT_KEY_DOWN)
+        {
+            COLORREF color;
+
+            if (color_from_key((int) event->key.key, color))
+            {
+                if (hit_test(cursor_position()))
+                {
+                    change_color((int) color);
+                    needs_update = UPDATE_SETTINGS_CHANGED;
+                    return true;
+                }
+            }
+            else if (event->key.key == SDLK_DELETE)
+            {
+                if (hit_test(cursor_position()))
+                {
+                    deleted() = true;
+                    needs_update = UPDATE_SETTINGS_CHANGED;
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    // Draws with the transforms of `view` (a snapshot's), on the render thread
+    void draw(const SceneTransforms &view, const SDL_FPoint &pt, float alpha, const OverlayWindow &overlay, QuadBatch &batch) const
+    {
+        if (surface && overlay.renderer)
+        {
+            const SDL_Rect &ext = view.extent[slot];
+            SDL_Texture *tex = asset_cache.texture(this, surface_version, surface, overlay.renderer);
+
+            if (!tex) return;
+            batch.add(
+                    tex,
+                    pt.x - (float)ext.x, pt.y - (float)ext.y,
+                    (float)ext.w, (float)ext.h,
+                    view.scale[slot], view.rotate[slot],
+                    false, false,
+                    BLENDED_ALPHA_FLOAT(view.alpha[slot], alpha));
+        }
+    }
+
+    // Recolors the surface in place, every window uploads it again
+    bool change_color(COLORREF color)
+    {
+        if (!valid()) return false;
+
+        std::lock_guard lock(asset_cache.mutex);
+        auto pixels = (Uint32*)surface->pixels;
+        auto format_details = SDL_GetPixelFormatDetails(surface->format);
+        int totalPixels = surface->w * surface->h;
+
+        for (int i = 0; i < totalPixels; ++i)
+        {
+            Uint8 r, g, b, a;
+            SDL_GetRGBA(pixels[i], format_details, nullptr, &r, &g, &b, &a);
+
+            // (premultiplied)
+            Uint32 px = SDL_MapRGBA(
+                    format_details, nullptr,
+                    (Uint8)(GetRValue(color) * a / 255),
+                    (Uint8)(GetGValue(color) * a / 255),
+                    (Uint8)(GetBValue(color) * a / 255),
+                    a);
+            pixels[i] = px;
+        }
+
+        font_color = color;
+        surface_version++;
+
+        return true;
+    }
+
+};
+
+
+class Image : public ScreenObject
+{
+public:
+    string name;
+    string full_path;
+    SDL_Surface *surface;
+
+protected:
+    Image(SceneTransforms *tf, Uint32 slot, float x, float y)
+    : ScreenObject(tf, slot, x, y),
+    surface((SDL_Surface*)nullptr)
+    {}
+
+public:
+    Image(
+        SceneTransforms *tf,
+        Uint32 slot,
+        float x, float y,
+        const string &name,
+        const path &base_path,
+        float scale_by,
+        float rotate_by,
+        bool flip_horizontal,
+        float alpha)
+        : ScreenObject(tf, slot, x, y),
+          surface((SDL_Surface*)nullptr)
+    {
+        full_path = (base_path / name).string();
+        init(x, y, name, full_path, scale_by, rotate_by, flip_horizontal, alpha);
+    }
+
+    Image(SceneTransforms *tf, Uint32 slot, json &j)
+    : ScreenObject(tf, slot, -1, -1),
+    surface((SDL_Surface*)nullptr)
+    {
+        try
+        {
+            init(
+                j["x"], j["y"],
+                j.value("image_name", ""),
+                j.value("image_full_path", ""),
+                j.value("scale", 1.f),
+                j.value("rotate", 0.f),
+                j.value("flip_horizontal", false),
+                j.value("alpha", 1.f));
+        }
+        catch (const std::exception &e)
+        {
+            SDL_Log("Error creating image: %s", e.what());
+        }
+    }
+
+    [[nodiscard]]
+    const char* type_name() const {return "Image";}
+
+    ~Image()
+    {
+        asset_cache.forget(this);
+        asset_cache.release_surface(surface);
+        surface = nullptr;
+    };
+
+protected:
+    void init(
+            float x, float y,
+            const string &name,
+            const string &full_path,
+            float scale_by,
+            float rotate_by,
+            bool flip_horizontal,
+            float alpha)
+    {
+        this->name = name;
+        this->full_path = full_path;
+        set_pos({x, y});
+        scale() = scale_by;
+        rotate() = rotate_by;
+        flip() = flip_horizontal;
+        this->alpha() = alpha;
+
+        // load the Image (shared with other objects showing the same file)
+        surface = asset_cache.load_surface(full_path);
+
+        if (!surface)
+        {
+            SDL_Log("Error loading \"%s\":\n   %s", name.c_str(), SDL_GetError());
+        }
+        else if (!asset_cache.fits_texture(surface))
+        {
+            // (Textures are uploaded when first drawn, so the size is checked here)
+            SDL_Log("Image \"%s\" is too large for a texture", name.c_str());
+        }
+        else if (SDL_GetSurfaceClipRect(surface, &extent()))
+        {
+            extent().x = extent().w / 2;
+            extent().y = extent().h / 2;
+            return;
+        }
+
+        asset_cache.release_surface(surface);
+        surface = nullptr;
+    }
+
+public:
+    [[nodiscard]]
+    json to_json() const
+    {
+        if (!valid()) return json::object();
+
+        return json( {
+             {"id", tf->id[slot]},
+             {"x", (int)pos().x},
+             {"y", (int)pos().y},
+             {"image_name", name},
+             {"image_full_path", full_path},
+             {"scale", round_to_precision(scale(), 4)},
+             {"rotate", round_to_precision(rotate(), 4)},
+             {"flip_horizontal", (bool)flip()},
+             {"alpha", round_to_precision(alpha(), 2)},
+             {"type", type_name()}
+        });
+    }
+
+    [[nodiscard]]
+    bool valid() const
+    {
+        // (The surface is only kept if it fits a texture)
+        return (bool)surface && !deleted();
+    }
+
+    [[nodiscard]]
+    bool hit_test(SDL_FPoint pt) const
+    {
+        SDL_FPoint local;
+
+        if (!valid()) return false;
+
+        if (tf->contains(slot, pt, &local))
+        {
+            // (The render thread may be uploading the surface, or composing a GIF frame into it)
+            std::lock_guard lock(asset_cache.mutex);
+            Uint8 alpha;
+            int xoff = (int)local.x;
+            int yoff = (int)local.y;
+            if (flip())
+            {
+                xoff = extent().w - xoff - 1;
+            }
+            if (SDL_ReadSurfacePixel(surface, xoff, yoff, nullptr, nullptr, nullptr, &alpha))
+            {
+                return alpha > 50;
+            }
+        }
+
+        return false;
+    }
+
+    bool handle_event(const SDL_Event* event, int &needs_update, AppContext *app)
+    {
+        if (!app->layout_mode || !valid()) return false;
+
+        if (event->type == SDL_EVENT_MOUSE_WHEEL)
+        {
+            SDL_FPoint pt(event->wheel.mouse_x, event->wheel.mouse_y);
+
+            if (hit_test(pt))
+            {
+                if (SDL_GetModState() & SDL_KMOD_CTRL)
+                {
+                    // Rotate image (when ctrl is pressed)
+                    SDL_FPoint ct(pt.x, pt.y);
+                    SDL_FPoint p = pos();
+                    double phi_delta = 5 * app->wheel_net_steps;
+                    rotate_point(ct, &p, phi_delta);
+                    set_pos(p);
+                    rotate() += (float) phi_delta;
+                }
+                else if (SDL_GetModState() & SDL_KMOD_SHIFT)
+                {
+                    // Scale image
+                    float dScale = powf(1.1f, event->wheel.y);
+                    SDL_FPoint p = pos();
+                    scale() *= dScale;
+                    p.x += (float) ((p.x - pt.x) * (dScale - 1.0));
+                    p.y += (float) ((p.y - pt.y) * (dScale - 1.0));
+                    set_pos(p);
+                }
+                else
+                {
+                    // Change text alpha
+                    alpha() = SDL_clamp(alpha() + (float)app->wheel_net_steps * (5.f / 255.f), 0.f, 1.f);
+                }
+                needs_update = UPDATE_SETTINGS_CHANGED;
+                return true;
+            }
+        }
+
+        else if (event->type == SDL_EVENT_MOUSE_BUTTON_DOWN)
+        {
+            SDL_FPoint pt(event->motion.x, event->motion.y);
+
+            if (hit_test(pt))
+            {
+                app->mouse_capture = handle();
+                app->dragging_origin = pt;
+                app->dragging_offset = SDL_FPoint(
+                    pt.x - pos().x,
+                    pt.y - pos().y
+                );
+                return true;
+            }
+        }
+
+        else if (event->type == SDL_EVENT_MOUSE_BUTTON_UP)
+        {
+            if (app->mouse_capture == handle())
+            {
+                SDL_FPoint p = app->dragging_origin;
+                p.x -= app->dragging_offset.x;
+                p.y -= app->dragging_offset.y;
+                set_pos(p);
+                app->mouse_capture = {};
+                app->dragging_offset = {0};
+                needs_update = UPDATE_SETTINGS_CHANGED;
+                return true;
+            }
+        }
+
+        else if (event->type == SDL_EVENT_MOUSE_MOTION)
+        {
+            SDL_FPoint pt(event->motion.x, event->motion.y);
+
+            if (app->mouse_capture == handle())
+            {
+                app->dragging_origin = pt;
+                needs_update = UPDATE_VIEW_CHANGED;
+                return true;
+            }
+            else
+            {
+                if (!app->mouse_capture && hit_test(pt))
+                {
+                    SDL_SetCursor(app->handCursor);
+                    return true;
+                }
+            }
+        }
+
+        else if (event->type == SDL_EVENT_KEY_DOWN)
+        {
+            if (event->key.key == SDLK_F)
+            {
+                if (hit_test(cursor_position()))
+                {
+                    flip() = !flip();
+                    needs_update = UPDATE_SETTINGS_CHANGED;
+                    return true;
+                }
+            }
+            else if (event->key.key == SDLK_DELETE)
+            {
+                if (hit_test(cursor_position()))
+                {
+                    deleted() = true;
+                    needs_update = UPDATE_SETTINGS_CHANGED;
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    void draw(const SceneTransforms &view, const SDL_FPoint &pt, float alpha, const OverlayWindow &overlay, QuadBatch &batch) const
+    {
+        if (!surface || !overlay.renderer) return;
+
+        const SDL_Rect &ext = view.extent[slot];
+        float x = pt.x - (float)ext.x;
+        float y = pt.y - (float)ext.y;
+        float w = (float)ext.w;
+        float h = (float)ext.h;
+        SDL_Texture *tex = asset_cache.texture(this, 0, surface, overlay.renderer);
+
+        if (!tex) return;
+        batch.add(
+                tex,
+                x, y, w, h,
+                view.scale[slot], view.rotate[slot],
+                view.flip[slot], false,
+                BLENDED_ALPHA_FLOAT(view.alpha[slot], alpha));
+    }
+
+};
+
+
+// GIF decoder of the animation path, reads the file from memory (the mapped source).
+// Frames are indexed once on open, their color tables point into the file.
+// Decoding a frame runs the LZW codes through fixed tables straight into the canvas,
+// deinterlacing and skipping transparent pixels on the way, with no heap allocations.
+// Files it can't index are left to giflib.
+class GifDecoder
+{
+public:
+    struct Frame
+    {
+        int left;
+        int top;
+        int width;
+        int height;
+        bool interlaced;
+        const GifColorType *colors;  // Local color table, or the global one
+        int color_count;
+        int delay_ms;
+        int transparent_color_index;
+        int disposal_mode;
+        size_t data;                 // Offset of the LZW minimum code size, the data sub-blocks follow
+    };
+
+    int width = 0;
+    int height = 0;
+    int bg_color = 0;
+    int loop_count = -1;                   // NETSCAPE2.0 loop count (0: forever, -1: none)
+    const GifColorType *colors = nullptr;  // Global color table
+    int color_count = 0;
+    vector<Frame> frames;
+
+    // Indexes the frames of `file`, false if it is no GIF or has no complete frame
+    bool open(const MappedFile *file)
+    {
+        frames.clear();
+        loop_count = -1;
+        data = file->data;
+        size = file->size;
+        if (size < 13 || memcmp(data, "GIF", 3) != 0) return false;
+
+        width = data[6] | data[7] << 8;
+        height = data[8] | data[9] << 8;
+        bg_color = data[11];
+        size_t pos = 13;
+        if (!read_color_table(data[10], pos, colors, color_count)) return false;
+
+        // Graphics control of the next frame
+        int delay_ms = 100;
+        int transparent_color_index = NO_TRANSPARENT_COLOR;
+        int disposal_mode = DISPOSAL_UNSPECIFIED;
+
+        while (pos < size)
+        {
+            switch (data[pos++])
+            {
+                case extension_introducer:
+                {
+                    if (pos >= size) return !frames.empty();
+                    int function = data[pos++];
+                    if (function == GRAPHICS_EXT_FUNC_CODE && pos + 5 <= size && data[pos] == 4)
+                    {
+                        Uint8 packed = data[pos + 1];
+                        delay_ms = (data[pos + 2] | data[pos + 3] << 8) * 10;
+                        transparent_color_index = (packed & 0x01) ? data[pos + 4] : NO_TRANSPARENT_COLOR;
+                        disposal_mode = (packed >> 2) & 0x07;
+                    }
+                    else if (function == APPLICATION_EXT_FUNC_CODE && pos + 16 <= size && data[pos] == 11 &&
+                             memcmp(data + pos + 1, "NETSCAPE2.0", 11) == 0 && data[pos + 12] == 3 && data[pos + 13] == 1)
+                    {
+                        loop_count = data[pos + 14] | data[pos + 15] << 8;
+                    }
+                    if (!skip_sub_blocks(pos)) return !frames.empty();
+                    break;
+                }
+                case descriptor_introducer:
+                {
+                    if (pos + 9 > size) return !frames.empty();
+                    Frame frame = {
+                        .left = data[pos] | data[pos + 1] << 8,
+                        .top = data[pos + 2] | data[pos + 3] << 8,
+                        .width = data[pos + 4] | data[pos + 5] << 8,
+                        .height = data[pos + 6] | data[pos + 7] << 8,
+                        .interlaced = (data[pos + 8] & 0x40) != 0,
+                        .colors = colors,
+                        .color_count = color_count,
+                        .delay_ms = delay_ms,
+                        .transparent_color_index = transparent_color_index,
+                        .disposal_mode = disposal_mode,
+                        .data = 0
+                    };
+                    Uint8 packed = data[pos + 8];
+                    pos += 9;
+                    if (!read_color_table(packed, pos, frame.colors, frame.color_count)) return !frames.empty();
+                    frame.data = pos++;
+                    if (!skip_sub_blocks(pos)) return !frames.empty();
+                    frames.push_back(frame);
+
+                    delay_ms = 100;
+                    transparent_color_index = NO_TRANSPARENT_COLOR;
+                    disposal_mode = DISPOSAL_UNSPECIFIED;
+                    break;
+                }
+                case terminator_introducer:
+                default:
+                    return !frames.empty();
+            }
+        }
+        return !frames.empty();
+    }
+
+    // Draws frame `index` onto the 32 bit `canvas`, `palette` maps all 256 color indices (0: skip pixel)
+    void decode(int index, const Uint32 *palette, SDL_Surface *canvas)
+    {
+        const Frame &frame = frames[index];
+        size_t pos = frame.data;
+        int min_code_size = data[pos++];
+        if (min_code_size < 1 || min_code_size > 8 || frame.width == 0) return;
+
+        // Pixel cursor, rows in interlace order (pass 4 is the plain order) clipped to the canvas
+        static const int pass_start[5] = {0, 4, 2, 1, 0};
+        static const int pass_step[5] = {8, 8, 4, 2, 1};
+        int pass = frame.interlaced ? 0 : 4;
+        int x = 0;
+        int y = 0;
+        int draw_width = SDL_clamp(canvas->w - frame.left, 0, frame.width);
+        Uint32 *row = nullptr;
+        auto seek_row = [&]() -> bool
+        {
+            while (y >= frame.height && pass < 3)
+            {
+                y = pass_start[++pass];
+            }
+            if (y >= frame.height) return false;
+            row = (frame.top + y < canvas->h)
+                ? (Uint32*)(void*)((Uint8*)canvas->pixels + (frame.top + y) * canvas->pitch) + frame.left
+                : nullptr;
+            return true;
+        };
+        if (!seek_row()) return;
+
+        // LSB first code reader over the data sub-blocks
+        Uint32 bits = 0;
+        int bit_count = 0;
+        size_t block_end = pos;
+        auto read_code = [&](int code_size) -> int
+        {
+            if (bit_count < code_size && pos + 2 <= block_end)
+            {
+                bits |= (Uint32)(data[pos] | data[pos + 1] << 8) << bit_count;
+                bit_count += 16;
+                pos += 2;
+            }
+            while (bit_count < code_size)
+            {
+                if (pos >= block_end)
+                {
+                    if (pos >= size || data[pos] == 0) return -1;
+                    block_end = SDL_min(pos + 1 + data[pos], size);
+                    pos++;
+                    continue;
+                }
+                bits |= (Uint32)data[pos++] << bit_count;
+                bit_count += 8;
+            }
+            int code = (int)(bits & ((1u << code_size) - 1));
+            bits >>= code_size;
+            bit_count -= code_size;
+            return code;
+        };
+
+        int clear_code = 1 << min_code_size;
+        int eoi_code = clear_code + 1;
+        int code_size = min_code_size + 1;
+        int next_code = eoi_code + 1;
+        int prev_code = -1;
+        for (int i = 0; i < clear_code; i++)
+        {
+            suffix[i] = first[i] = (Uint8)i;
+            length[i] = 1;
+        }
+
+        for (;;)
+        {
+            int code = read_code(code_size);
+            if (code < 0 || code == eoi_code) break;
+            if (code == clear_code)
+            {
+                code_size = min_code_size + 1;
+                next_code = eoi_code + 1;
+                prev_code = -1;
+                continue;
+            }
+
+            if (prev_code < 0)
+            {
+                if (code > clear_code) break;
+            }
+            else if (next_code < max_codes)
+            {
+                // New string: previous one plus the first byte of this one (itself for the KwKwK case)
+                if (code > next_code) break;
+                Uint8 first_byte = first[(code < next_code) ? code : prev_code];
+                prefix[next_code] = (Uint16)prev_code;
+                suffix[next_code] = first_byte;
+                first[next_code] = first[prev_code];
+                length[next_code] = length[prev_code] + 1;
+                next_code++;
+                if (next_code == (1 << code_size) && code_size < 12) code_size++;
+            }
+            prev_code = code;
+
+            // Strings within the drawn part of the row are unwound right into it,
+            // others through the string buffer and along the rows
+            int n = length[code];
+            if (row && x + n <= draw_width)
+            {
+                int c = code;
+                for (Uint32 *dst = row + x + n; dst > row + x; c = prefix[c])
+                {
+                    Uint32 color = palette[suffix[c]];
+                    --dst;
+                    if (color) *dst = color;
+                }
+                x += n;
+                if (x == frame.width)
+                {
+                    x = 0;
+                    y += pass_step[pass];
+                    if (!seek_row()) return;
+                }
+                continue;
+            }
+
+            Uint8 *out = suffix_stack + n;
+            for (int c = code; out > suffix_stack; c = prefix[c])
+            {
+                *--out = suffix[c];
+            }
+            while (n > 0)
+            {
+                int run = SDL_min(n, frame.width - x);
+                if (row)
+                {
+                    for (int i = x, end = SDL_min(x + run, draw_width); i < end; i++)
+                    {
+                        Uint32 color = palette[out[i - x]];
+                        if (color) row[i] = color;
+                    }
+                }
+                x += run;
+                out += run;
+                n -= run;
+                if (x == frame.width)
+                {
+                    x = 0;
+                    y += pass_step[pass];
+                    if (!seek_row()) return;
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr int max_codes = 4096;
+    static constexpr Uint8 extension_introducer = 0x21;
+    static constexpr Uint8 descriptor_introducer = 0x2c;
+    static constexpr Uint8 terminator_introducer = 0x3b;
+
+    const Uint8 *data = nullptr;
+    size_t size = 0;
+
+    // LZW string table, strings are stored as prefix code + last byte
+    Uint16 prefix[max_codes];
+    Uint8 suffix[max_codes];
+    Uint8 first[max_codes];
+    Uint16 length[max_codes];
+    Uint8 suffix_stack[max_codes];  // Bytes of a string unwound from its last byte
+
+    bool read_color_table(Uint8 packed, size_t &pos, const GifColorType *&table, int &count) const
+    {
+        if (!(packed & 0x80)) return true;
+
+        count = 2 << (packed & 0x07);
+        if (pos + 3 * (size_t)count > size) return false;
+        table = (const GifColorType *)(data + pos);
+        pos += 3 * (size_t)count;
+        return true;
+    }
+
+    bool skip_sub_blocks(size_t &pos) const
+    {
+        while (pos < size)
+        {
+            int n = data[pos++];
+            if (n == 0) return true;
+            pos += n;
+        }
+        return false;
+    }
+};
+
+
+class AnimatedGif : public Image
+{
+    struct frame_info_t {
+        int delay_ms;
+        int transparent_color_index;
+        int disposal_mode;
+        bool keyframe;  // Composed without the canvas before it
+    };
+
+public:
+    bool cache_frames;
+    int max_loops;        // Caps the loops the file asks for (0: no cap)
+    int checkpoint_frames;               // Composed canvas kept every that many frames (0: keyframes only)
+    vector<SDL_Surface *> checkpoints;
+    int loop_count;       // NETSCAPE2.0 loop count of the file (0: forever, -1: none, play once)
+    int loops_played;
+    bool finished;        // Last loop played, the last frame stays and the GIF is no longer scheduled
+    int frame_count;
+    int current_frame;
+    int recent_disposal;
+    Uint64 latest_ticks;
+    SDL_Rect previous_frame_rect;
+    vector<frame_info_t> frame_info;
+    GifFileType *gif;          // giflib fallback, if the decoder can't index the file
+    GifDecoder decoder;
+    IMG_Animation *animation;  // Composed frames of other formats
+    const MappedFile *source;  // Mapped GIF file, read by `decoder` or `gif`
+    size_t source_pos;
+    int surface_frame;     // Frame currently composed in `surface` (-1: none)
+
+    AnimatedGif(
+        SceneTransforms *tf,
+        Uint32 slot,
+        float x, float y,
+        const string &name,
+        const path &base_path,
+        float scale_by,
+        float rotate_by,
+        bool flip_horizontal,
+        float alpha,
+        bool cache_frames,
+        int max_loops,
+        int checkpoint_frames)
+    : Image(tf, slot, x, y),
+      gif((GifFileType*)nullptr),
+      animation(nullptr),
+      source(nullptr),
+      source_pos(0)
+    {
+        full_path = (base_path / name).string();
+        init(x, y, name, full_path, scale_by, rotate_by, flip_horizontal, alpha, cache_frames, max_loops, checkpoint_frames);
+    }
+
+    AnimatedGif(SceneTransforms *tf, Uint32 slot, json &j)
+    : Image(tf, slot, -1, -1),
+      gif((GifFileType*)nullptr),
+      animation(nullptr),
+      source(nullptr),
+      source_pos(0)
+    {
+        try
+        {
+            init(
+                j["x"], j["y"],
+                j.value("image_name", ""),
+                j.value("image_full_path", ""),
+                j.value("scale", 1.f),
+                j.value("rotate", 0.f),
+                j.value("flip_horizontal", false),
+                j.value("alpha", 1.f),
+                j.value("cache_frames", true),
+                j.value("max_loops", 0),
+                j.value("checkpoint_frames", 0));
+        }
+        catch (const std::exception &e)
+        {
+            SDL_Log("Error creating image: %s", e.what());
+        }
+    }
+
+    [[nodiscard]]
+    const char* type_name() const {return "AnimatedGif";}
+
+    ~AnimatedGif()
+    {
+        release_textures();
+        SDL_DestroySurface(surface);
+        surface = nullptr;
+        if (gif) DGifCloseFile(gif, nullptr);
+        if (animation) IMG_FreeAnimation(animation);
+        for (SDL_Surface *checkpoint : checkpoints)
+        {
+            SDL_DestroySurface(checkpoint);
+        }
+        asset_cache.unmap_file(source);
+    }
+
+protected:
+    void init(
+        float x, float y,
+        const string &name,
+        const string &full_path,
+        float scale_by,
+        float rotate_by,
+        bool flip_horizontal,
+        float alpha,
+        bool cache_frames,
+        int max_loops,
+        int checkpoint_frames)
+    {
+        this->name = name;
+        this->full_path = full_path;
+        set_pos({x, y});
+        scale() = scale_by;
+        rotate() = rotate_by;
+        flip() = flip_horizontal;
+        latest_ticks = SDL_GetTicks() + dist(gen) % 500;
+        frame_count = 0;
+        current_frame = 0;
+        recent_disposal = DISPOSAL_UNSPECIFIED;
+        this->alpha() = alpha;
+        this->cache_frames = cache_frames;
+        this->max_loops = max_loops;
+        this->checkpoint_frames = SDL_max(0, checkpoint_frames);
+        loop_count = -1;
+        loops_played = 0;
+        finished = false;
+        this->previous_frame_rect = {0, 0, 0, 0};
+        surface_frame = -1;
+
+        // Mapped GIFs go through the in-tree decoder, other GIFs through giflib,
+        // other formats (animated WebP, APNG) through SDL_image
+        int canvas_width = 0;
+        int canvas_height = 0;
+        source = asset_cache.map_file(full_path);
+        source_pos = 0;
+        bool gif_file = source
+                ? (source->size >= 3 && memcmp(source->data, "GIF", 3) == 0)
+                : path(full_path).extension() == ".gif" || path(full_path).extension() == ".GIF";
+        if (!gif_file)
+        {
+            animation = source
+                    ? IMG_LoadAnimation_IO(SDL_IOFromConstMem(source->data, source->size), true)
+                    : IMG_LoadAnimation(full_path.c_str());
+            if (!animation || animation->count == 0)
+            {
+                SDL_Log("Error loading \"%s\":\n   %s", name.c_str(), SDL_GetError());
+                return;
+            }
+
+            // Frames are converted once, SDL_image gives no loop count
+            canvas_width = animation->w;
+            canvas_height = animation->h;
+            loop_count = 0;
+            frame_count = animation->count;
+            for (int i = 0; i < frame_count; i++)
+            {
+                animation->frames[i] = asset_cache.to_native(animation->frames[i]);
+                if (animation->frames[i])
+                {
+                    SDL_SetSurfaceBlendMode(animation->frames[i], SDL_BLENDMODE_NONE);
+                }
+                frame_info.push_back({
+                    .delay_ms = animation->delays[i],
+                    .transparent_color_index = NO_TRANSPARENT_COLOR,
+                    .disposal_mode = DISPOSAL_UNSPECIFIED,
+                    .keyframe = false
+                });
+            }
+        }
+        else if (source && decoder.open(source))
+        {
+            canvas_width = decoder.width;
+            canvas_height = decoder.height;
+            loop_count = decoder.loop_count;
+            frame_count = (int)decoder.frames.size();
+            for (const GifDecoder::Frame &frame : decoder.frames)
+            {
+                frame_info.push_back({
+                    .delay_ms = frame.delay_ms,
+                    .transparent_color_index = frame.transparent_color_index,
+                    .disposal_mode = frame.disposal_mode,
+                    .keyframe = false
+                });
+            }
+        }
+        else
+        {
+            gif = source ? DGifOpen(this, read_source, nullptr) : DGifOpenFileName(full_path.c_str(), nullptr);
+            if (!gif)
+            {
+                SDL_Log("Error loading \"%s\":\n   %s", name.c_str(), SDL_GetError());
+                return;
+            }
+
+            GraphicsControlBlock gcb;
+
+            DGifSlurp(gif);
+            canvas_width = gif->SWidth;
+            canvas_height = gif->SHeight;
+            frame_count = gif->ImageCount;
+            if (frame_count > 0)
+            {
+                // (The NETSCAPE2.0 block precedes the first image)
+                loop_count = netscape_loop_count(gif->SavedImages[0].ExtensionBlocks, gif->SavedImages[0].ExtensionBlockCount);
+            }
+            for (int i = 0; i < frame_count; i++)
+            {
+                frame_info_t info {
+                    .delay_ms = 100,
+                    .transparent_color_index = NO_TRANSPARENT_COLOR,
+                    .disposal_mode = DISPOSAL_UNSPECIFIED,
+                    .keyframe = false
+                };
+
+                SavedImage *frame = &gif->SavedImages[i];
+                for (int j = 0; j < frame->ExtensionBlockCount; j++)
+                {
+                    ExtensionBlock *ext = &frame->ExtensionBlocks[j];
+                    if (ext && ext->Function == GRAPHICS_EXT_FUNC_CODE)
+                    {
+                        if (GIF_OK == DGifExtensionToGCB(ext->ByteCount, ext->Bytes, &gcb))
+                        {
+                            info.delay_ms = gcb.DelayTime * 10;
+                            info.transparent_color_index = gcb.TransparentColor;
+                            info.disposal_mode = gcb.DisposalMode;
+                            break;
+                        }
+                    }
+                }
+
+                frame_info.push_back(info);
+            }
+
+        }
+
+        surface = SDL_CreateSurface(canvas_width, canvas_height, asset_cache.pixel_format);
+        if (surface && !asset_cache.fits_texture(surface))
+        {
+            // (Frames are uploaded when first drawn, so the size is checked here)
+            SDL_Log("Animation \"%s\" is too large for a texture", name.c_str());
+            SDL_DestroySurface(surface);
+            surface = nullptr;
+        }
+        if (surface)
+        {
+            SDL_ClearSurface(surface, 0, 0, 0, 0);
+        }
+        if (!animation)
+        {
+            index_keyframes();
+            if (this->checkpoint_frames > 0)
+            {
+                checkpoints.assign(frame_count / this->checkpoint_frames, nullptr);
+            }
+        }
+        compose_frame(current_frame);
+        extent().w = canvas_width;
+        extent().h = canvas_height;
+        extent().x = extent().w / 2;
+        extent().y = extent().h / 2;
+    }
+
+public:
+    [[nodiscard]]
+    json to_json() const
+    {
+        if (!valid()) return json::object();
+
+        return json( {
+             {"id", tf->id[slot]},
+             {"x", (int)pos().x},
+             {"y", (int)pos().y},
+             {"image_name", name},
+             {"image_full_path", full_path},
+             {"scale", round_to_precision(scale(), 4)},
+             {"rotate", round_to_precision(rotate(), 4)},
+             {"flip_horizontal", (bool)flip()},
+             {"alpha", round_to_precision(alpha(), 2)},
+             {"cache_frames", (bool)cache_frames},
+             {"max_loops", max_loops},
+             {"checkpoint_frames", checkpoint_frames},
+             {"type", type_name()}
+        });
+    }
+
+    bool handle_event(const SDL_Event* event, int &needs_update, AppContext *app)
+    {
+        bool result = valid() && Image::handle_event(event, needs_update, app);
+
+        // Transform changes (move, scale, rotate, alpha, flip) are applied when drawing, the frames stay cached
+        // (they depend on the file content only, which no event changes).
+        // Deleted objects are only flagged, so their textures go right away.
+        if (result && deleted())
+        {
+            release_textures();
+        }
+
+        return result;
+    }
+
+    // Texture of frame `index` for `renderer`, the frame is composed and uploaded if the window hasn't got it.
+    // With frame caching every frame is uploaded once per window, otherwise each window keeps the latest frame.
+    // (Called with `asset_cache.mutex` held)
+    SDL_Texture *frame_texture(int index, const SDL_Renderer *renderer)
+    {
+        const void *owner = cache_frames ? (const void *)&frame_info[index] : (const void *)this;
+        Uint32 version = cache_frames ? 0 : (Uint32)index;
+        SDL_Texture *texture = asset_cache.texture(owner, version, nullptr, renderer);
+
+        if (!texture && compose_frame(index))
+        {
+            texture = asset_cache.texture(owner, version, surface, renderer);
+        }
+        return texture;
+    }
+
+    // Draws `frame` (the snapshot's) with the transforms of `view`, on the render thread
+    void draw(const SceneTransforms &view, int frame, const SDL_FPoint &pt, float alpha, const OverlayWindow &overlay, QuadBatch &batch)
+    {
+        // If the GIF is not valid or the renderer is not available, do nothing.
+        if (!surface || !overlay.renderer || frame < 0 || frame >= (int)frame_info.size()) return;
+
+        SDL_Texture *texture = frame_texture(frame, overlay.renderer);
+        if (!texture) return;
+
+        // Calculate the position and dimensions of the GIF on the screen.
+        const SDL_Rect &ext = view.extent[slot];
+        float x = pt.x - (float)ext.x;
+        float y = pt.y - (float)ext.y;
+        float w = (float)ext.w;
+        float h = (float)ext.h;
+
+        // Queue the current frame of the GIF with the specified transformations.
+        batch.add(
+                texture,
+                x, y, w, h,
+                view.scale[slot], view.rotate[slot],
+                view.flip[slot], false,
+                BLENDED_ALPHA_FLOAT(view.alpha[slot], alpha));
+    }
+
+    // Steps to the next frame, false once the last loop has ended (the last frame stays)
+    bool advance_frame()
+    {
+        if (current_frame + 1 >= frame_count)
+        {
+            // A NETSCAPE2.0 loop count repeats the animation that many times after the first play
+            int plays = (loop_count < 0) ? 1 : (loop_count == 0) ? 0 : loop_count + 1;
+            if (max_loops > 0)
+            {
+                plays = (plays == 0) ? max_loops : SDL_min(plays, max_loops);
+            }
+
+            loops_played++;
+            if (plays > 0 && loops_played >= plays)
+            {
+                finished = true;
+                return false;
+            }
+        }
+        current_frame = (current_frame + 1) % frame_count;
+        return true;
+    }
+
+    // Steps over all frames due at `ticks`, so the animation keeps its pace after stalls or while hidden.
+    // The skipped frames are not composed, `frame_texture()` seeks to the new one when it is drawn.
+    // Returns false once the last loop has ended.
+    bool catch_up(Uint64 ticks)
+    {
+        Uint64 due = latest_ticks;
+        int steps = 0;
+
+        do
+        {
+            due += frame_info[current_frame].delay_ms;
+            if (!advance_frame()) return false;
+        }
+        while (++steps < frame_count && frame_info[current_frame].delay_ms > 0 &&
+               ticks >= due + frame_info[current_frame].delay_ms);
+
+        // (Stalls longer than a loop and zero delays restart the pace)
+        latest_ticks = (steps < frame_count && frame_info[current_frame].delay_ms > 0) ? due : ticks;
+        return true;
+    }
+
+    // Loop count of a NETSCAPE2.0 application block among the slurped `blocks` (-1: none)
+    static int netscape_loop_count(const ExtensionBlock *blocks, int count)
+    {
+        for (int j = 0; j + 1 < count; j++)
+        {
+            const ExtensionBlock &app = blocks[j];
+            const ExtensionBlock &sub = blocks[j + 1];
+            if (app.Function == APPLICATION_EXT_FUNC_CODE && app.ByteCount == 11 &&
+                memcmp(app.Bytes, "NETSCAPE2.0", 11) == 0 &&
+                sub.Function == CONTINUE_EXT_FUNC_CODE && sub.ByteCount >= 3 && sub.Bytes[0] == 1)
+            {
+                return sub.Bytes[1] | sub.Bytes[2] << 8;
+            }
+        }
+        return -1;
+    }
+
+    // giflib input function, copies the next `length` bytes of the mapped file
+    static int read_source(GifFileType *gif, GifByteType *buffer, int length)
+    {
+        auto self = (AnimatedGif *)gif->UserData;
+        size_t count = SDL_min((size_t)length, self->source->size - self->source_pos);
+
+        memcpy(buffer, self->source->data + self->source_pos, count);
+        self->source_pos += count;
+        return (int)count;
+    }
+
+    // Brings `surface` to frame `index` (if it doesn't hold it already), false if that fails
+    bool compose_frame(int index)
+    {
+        if (surface_frame == index) return true;
+
+        // If the surface is not valid or not a 32 bit format, do nothing.
+        if (!surface || SDL_BYTESPERPIXEL(surface->format) != 4) return false;
+
+        if (animation)
+        {
+            if (!animation->frames[index]) return false;
+            // (Frames come composed, so they are copied over)
+            SDL_BlitSurface(animation->frames[index], nullptr, surface, nullptr);
+        }
+        else if (!compose_to(index))
+        {
+            return false;
+        }
+        surface_frame = index;
+        return true;
+    }
+
+    // Brings the canvas to GIF frame `index`. Composition continues from the frame on the canvas if that
+    // comes first, or restarts at the nearest keyframe or checkpoint before `index`, whatever is closer.
+    // With checkpoints every K frames this costs at most K frame decodes.
+    bool compose_to(int index)
+    {
+        int start = index;
+        while (start > 0 && !frame_info[start].keyframe && !checkpoint_at(start - 1))
+        {
+            start--;
+        }
+
+        if (surface_frame >= start - 1 && surface_frame < index)
+        {
+            // Continue
+            start = surface_frame + 1;
+        }
+        else if (start > 0 && !frame_info[start].keyframe)
+        {
+            // Checkpoint of the frame before
+            SDL_BlitSurface(checkpoint_at(start - 1), nullptr, surface, nullptr);
+            recent_disposal = frame_info[start - 1].disposal_mode;
+            gif_frame(start - 1, previous_frame_rect);
+        }
+        else
+        {
+            // Keyframe, the canvas before it doesn't matter
+            SDL_ClearSurface(surface, 0, 0, 0, 0);
+            recent_disposal = DISPOSAL_UNSPECIFIED;
+        }
+
+        for (int i = start; i <= index; i++)
+        {
+            if (!compose_gif_frame(i)) return false;
+            surface_frame = i;
+
+            if (checkpoint_frames > 0 && (i + 1) % checkpoint_frames == 0 && !checkpoint_at(i))
+            {
+                SDL_Surface *checkpoint = SDL_DuplicateSurface(surface);
+                if (checkpoint)
+                {
+                    SDL_SetSurfaceBlendMode(checkpoint, SDL_BLENDMODE_NONE);
+                    checkpoints[i / checkpoint_frames] = checkpoint;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Composed canvas after frame `index`, if checkpointed
+    [[nodiscard]]
+    SDL_Surface *checkpoint_at(int index) const
+    {
+        if (checkpoint_frames <= 0 || (index + 1) % checkpoint_frames != 0) return nullptr;
+        size_t slot = index / checkpoint_frames;
+        return (slot < checkpoints.size()) ? checkpoints[slot] : nullptr;
+    }
+
+    // Position, color table and (giflib only) pixels of GIF frame `index`
+    bool gif_frame(
+            int index,
+            SDL_Rect &rect,
+            const GifColorType **colors = nullptr,
+            int *color_count = nullptr,
+            const Uint8 **raster_bits = nullptr) const
+    {
+        const GifColorType *frame_colors;
+        int frame_color_count;
+        const Uint8 *frame_bits = nullptr;
+
+        if (!decoder.frames.empty())
+        {
+            const GifDecoder::Frame &frame = decoder.frames[index];
+            rect = {frame.left, frame.top, frame.width, frame.height};
+            frame_colors = frame.colors;
+            frame_color_count = frame.color_count;
+        }
+        else
+        {
+            if (!gif || !gif->SavedImages) return false;
+            const SavedImage *frame = &gif->SavedImages[index];
+            const ColorMapObject *color_map = frame->ImageDesc.ColorMap ? frame->ImageDesc.ColorMap : gif->SColorMap;
+            rect = {frame->ImageDesc.Left, frame->ImageDesc.Top, frame->ImageDesc.Width, frame->ImageDesc.Height};
+            frame_bits = frame->RasterBits;
+            if (!frame_bits || !color_map) return false;
+            frame_colors = color_map->Colors;
+            frame_color_count = color_map->ColorCount;
+        }
+        if (!frame_colors) return false;
+
+        if (colors) *colors = frame_colors;
+        if (color_count) *color_count = frame_color_count;
+        if (raster_bits) *raster_bits = frame_bits;
+        return true;
+    }
+
+    // Background fill of the DISPOSE_BACKGROUND disposal before a frame with `color_count` colors
+    [[nodiscard]]
+    bool disposes_to_transparent(int color_count) const
+    {
+        int bg_color = !decoder.frames.empty() ? decoder.bg_color : gif->SBackGroundColor;
+        return bg_color == NO_TRANSPARENT_COLOR || bg_color < color_count;
+    }
+
+    // Marks the frames whose result doesn't depend on the canvas before them: the first one,
+    // opaque frames covering the canvas, and frames after one that disposes the whole canvas to transparent
+    void index_keyframes()
+    {
+        SDL_Rect canvas = {0, 0, surface ? surface->w : 0, surface ? surface->h : 0};
+        auto covers_canvas = [&](int index)
+        {
+            SDL_Rect rect;
+            SDL_Rect covered;
+            return gif_frame(index, rect) &&
+                   SDL_GetRectIntersection(&rect, &canvas, &covered) && SDL_RectsEqual(&covered, &canvas);
+        };
+
+        for (int i = 0; i < frame_count; i++)
+        {
+            SDL_Rect rect;
+            int color_count = 0;
+            gif_frame(i, rect, nullptr, &color_count);
+
+            frame_info[i].keyframe =
+                (i == 0) ||
+                (covers_canvas(i) && frame_info[i].transparent_color_index == NO_TRANSPARENT_COLOR) ||
+                (frame_info[i - 1].disposal_mode == DISPOSE_BACKGROUND && covers_canvas(i - 1) &&
+                 disposes_to_transparent(color_count));
+        }
+    }
+
+    // Draws GIF frame `index` onto the canvas, after disposing of the previous one
+    bool compose_gif_frame(int index)
+    {
+        int left, top, width, height;
+        const GifColorType *colors;
+        int color_count;
+        const Uint8 *raster_bits = nullptr;
+        int transparent_color;
+        Uint32 *addr;
+        SDL_Rect rect;
+
+        // Prepare canvas for the current frame
+        if (!gif_frame(index, rect, &colors, &color_count, &raster_bits)) return false;
+        left = rect.x;
+        top = rect.y;
+        width = rect.w;
+        height = rect.h;
+
+        // Handle the disposal method of the previous frame.
+        switch (recent_disposal)
+        {
+            case DISPOSE_BACKGROUND:
+            {
+                // Clear the area of the previous frame to the background color.
+                int bg_color = !decoder.frames.empty() ? decoder.bg_color : gif->SBackGroundColor;
+                if (disposes_to_transparent(color_count))
+                {
+                    SDL_FillSurfaceRect(surface, &previous_frame_rect, 0);
+                }
+                else
+                {
+                    const GifColorType *color = &colors[bg_color];
+                    const SDL_PixelFormatDetails* format_details = SDL_GetPixelFormatDetails(surface->format);
+                    Uint32 mapped_color = SDL_MapRGBA(
+                            format_details,
+                            nullptr,
+                            color->Red,
+                            color->Green,
+                            color->Blue,
+                            255);
+                    SDL_FillSurfaceRect(surface, &previous_frame_rect, mapped_color);
+                }
+                break;
+            }
+            case DISPOSE_DO_NOT:
+                // Do nothing, the previous frame is kept.
+                break;
+            case DISPOSAL_UNSPECIFIED:
+            default: // DISPOSE_NONE
+                // Do nothing, just overwrite the previous frame.
+                break;
+        }
+
+        transparent_color = frame_info[index].transparent_color_index;
+
+        // Pre-calculate the palette colors for the current frame to optimize the rendering loop.
+        // Indices beyond the color table and the transparent one map to zero, such pixels are skipped.
+        // (Pixels are either opaque or zero, so the canvas is premultiplied as it is.)
+        Uint32 palette_colors[256] = {0};
+        const SDL_PixelFormatDetails* format_details = SDL_GetPixelFormatDetails(surface->format);
+        for (int i = 0; i < SDL_min(color_count, 256); i++)
+        {
+            if (i == transparent_color) {
+                // Set the transparent color to have an alpha of 0 (values of R, G, B don't matter, since alpha is zero).
+                palette_colors[i] = 0;
+            } else {
+                // Set the other colors with an alpha of 255 (fully opaque).
+                palette_colors[i] = SDL_MapRGBA(
+                        format_details,
+                        nullptr,
+                        colors[i].Red,
+                        colors[i].Green,
+                        colors[i].Blue,
+                        255);
+            }
+        }
+
+        // Lock the surface to directly access the pixels.
+        SDL_LockSurface(surface);
+        if (!raster_bits)
+        {
+            // Decode straight into the surface.
+            decoder.decode(index, palette_colors, surface);
+        }
+        else
+        {
+            // Iterate over the pixels of the slurped frame and update the surface.
+            for (int i = 0; i < height; i++)
+            {
+                addr = (Uint32*)(void*)((Uint8*)surface->pixels + (i + top) * surface->pitch) + left;
+                for (int j = 0; j < width; j++)
+                {
+                    // Only draw the pixel if it is not transparent.
+                    Uint32 color = palette_colors[*raster_bits++];
+                    if (color) *addr = color;
+
+                    addr++;
+                }
+            }
+        }
+        SDL_UnlockSurface(surface);
+
+        // Store the rectangle and the disposal method of the current frame for the next iteration.
+        previous_frame_rect = rect;
+        recent_disposal = frame_info[index].disposal_mode;
+        return true;
+    }
+
+    // Frees the frame textures of all windows (deleted objects, destruction), they are uploaded again when needed
+    void release_textures()
+    {
+        for (auto &info : frame_info)
+        {
+            asset_cache.forget(&info);
+        }
+        asset_cache.forget(this);
+    }
+
+};
+
+
+// Repeating grid of one logo or text across the whole work area (watermark).
+// All tiles share one texture and are queued as instanced quads, so they end up in a single draw call.
+// The object's transform applies to the grid: position is the grid origin, scale zooms tiles and spacing,
+// rotation turns each tile.
+class TiledPattern : public ScreenObject
+{
+public:
+    // Asset: either an image file or a text
+    string name;
+    string full_path;
+    string text;
+    string font_name;
+    float font_size;
+    COLORREF font_color;
+
+    // Layout
+    float spacing_x;      // Horizontal distance of tiles (at scale 1)
+    float spacing_y;      // Vertical distance of tiles (at scale 1)
+    float stagger;        // Horizontal offset of odd rows, as fraction of `spacing_x`
+    float jitter;         // Maximal random displacement of a tile (at scale 1)
+    float rotate_jitter;  // Maximal random rotation of a tile in degrees
+    Uint32 seed;          // Seed for the (deterministic) jitter
+
+    SDL_Surface *surface;
+
+    static constexpr int max_tiles = 20000;
+
+    TiledPattern(SceneTransforms *tf, Uint32 slot, json &j, const path &base_path)
+    : ScreenObject(tf, slot, -1, -1),
+      surface(nullptr)
+    {
+        try
+        {
+            name = j.value("image_name", "");
+            full_path = j.value("image_full_path", "");
+            text = j.value("text", "");
+            font_name = j.value("font_name", "Freeman-Regular.TTF");
+            font_size = j.value("font_size", 80.f);
+            font_color = get_color_value(j, "font_color", 0xffffff);
+            spacing_x = j.value("spacing_x", 400.f);
+            spacing_y = j.value("spacing_y", 300.f);
+            stagger = j.value("stagger", 0.5f);
+            jitter = j.value("jitter", 0.f);
+            rotate_jitter = j.value("rotate_jitter", 0.f);
+            seed = j.value("seed", 0u);
+
+            set_pos({j["x"], j["y"]});
+            scale() = j.value("scale", 1.f);
+            rotate() = j.value("rotate", 0.f);
+            alpha() = j.value("alpha", 1.f);
+            flip() = j.value("flip_horizontal", false);
+
+            init(base_path);
+        }
+        catch (const std::exception &e)
+        {
+            SDL_Log("Error creating tiled pattern: %s", e.what());
+        }
+    }
+
+    [[nodiscard]]
+    const char* type_name() const {return "TiledPattern";}
+
+    ~TiledPattern()
+    {
+        asset_cache.forget(this);
+        release_surface();
+    }
+
+protected:
+    void init(const path &base_path)
+    {
+        if (!full_path.empty())
+        {
+            // Image asset (shared with other objects showing the same file)
+            surface = asset_cache.load_surface(full_path);
+
+            if (!surface)
+            {
+                SDL_Log("Error loading \"%s\":\n   %s", name.c_str(), SDL_GetError());
+            }
+        }
+        else
+        {
+            // Text asset
+            auto font_fullpath = base_path / font_name;
+            TTF_Font *font = asset_cache.open_font(font_fullpath.string(), font_size);
+
+            if (font)
+            {
+                surface = asset_cache.to_native(TTF_RenderText_Blended(
+                    font,
+                    text.c_str(), text.length(),
+                    SDL_Color(
+                            GetBValue(font_color),
+                            GetGValue(font_color),
+                            GetRValue(font_color),
+                            255)
+                ));
+                asset_cache.close_font(font);
+            }
+        }
+
+        if (surface && !asset_cache.fits_texture(surface))
+        {
+            // (The tile texture is uploaded when first drawn, so the size is checked here)
+            SDL_Log("Pattern tile is too large for a texture");
+            release_surface();
+        }
+        if (surface)
+        {
+            extent() = {surface->w / 2, surface->h / 2, surface->w, surface->h};
+        }
+    }
+
+    void release_surface()
+    {
+        if (!full_path.empty())
+        {
+            asset_cache.release_surface(surface);
+        }
+        else
+        {
+            SDL_DestroySurface(surface);
+        }
+        surface = nullptr;
+    }
+
+    // Deterministic noise in [-1, 1] for tile (i, j)
+    [[nodiscard]]
+    float tile_noise(int i, int j, Uint32 channel) const
+    {
+        Uint32 h = seed ^ ((Uint32)i * 0x9E3779B1u) ^ ((Uint32)j * 0x85EBCA77u) ^ (channel * 0xC2B2AE3Du);
+
+        h ^= h >> 15;
+        h *= 0x2C1B3C6Du;
+        h ^= h >> 12;
+        h *= 0x297A2D39u;
+        h ^= h >> 15;
+
+        return (float)(h & 0xFFFFFF) / (float)0x7FFFFF - 1.f;
+    }
+
+    // Effective (scaled) tile spacing, widened if `area` (an overlay window's) would hold more than `max_tiles` tiles.
+    // (The grid helpers take the transforms of the scene, or of the snapshot drawn)
+    void tile_spacing(const SceneTransforms &view, const SDL_Rect &area, float &sx, float &sy) const
+    {
+        sx = SDL_max(4.f, spacing_x * view.scale[slot]);
+        sy = SDL_max(4.f, spacing_y * view.scale[slot]);
+
+        float count = ((float)area.w / sx + 3.f) * ((float)area.h / sy + 3.f);
+        if (count > (float)max_tiles)
+        {
+            float f = sqrtf(count / (float)max_tiles);
+            sx *= f;
+            sy *= f;
+        }
+    }
+
+    // Center and rotation of tile (i, j) for the grid origin `origin`
+    void tile_transform(
+            const SceneTransforms &view,
+            int i, int j,
+            SDL_FPoint origin,
+            float sx, float sy,
+            SDL_FPoint &center,
+            float &angle) const
+    {
+        center.x = origin.x + (float)i * sx + ((j & 1) ? stagger * sx : 0.f);
+        center.y = origin.y + (float)j * sy;
+        angle = view.rotate[slot];
+
+        if (jitter != 0.f)
+        {
+            center.x += tile_noise(i, j, 0) * jitter * view.scale[slot];
+            center.y += tile_noise(i, j, 1) * jitter * view.scale[slot];
+        }
+        if (rotate_jitter != 0.f)
+        {
+            angle += tile_noise(i, j, 2) * rotate_jitter;
+        }
+    }
+
+    // Calls `f(i, j)` for all tiles that may touch the rectangle (x0, y0)-(x1, y1)
+    template <class F>
+    void for_tiles(
+            const SceneTransforms &view,
+            SDL_FPoint origin,
+            float sx, float sy,
+            float x0, float y0, float x1, float y1,
+            F &&f) const
+    {
+        // Margin for the tile size, stagger and jitter
+        const SDL_Rect &ext = view.extent[slot];
+        float s = view.scale[slot];
+        float reach = (float)SDL_max(ext.w, ext.h) * s + fabsf(jitter * s);
+        int j0 = (int)floorf((y0 - reach - origin.y) / sy);
+        int j1 = (int)ceilf((y1 + reach - origin.y) / sy);
+        int i0 = (int)floorf((x0 - reach - sx - origin.x) / sx);
+        int i1 = (int)ceilf((x1 + reach - origin.x) / sx);
+
+        for (int j = j0; j <= j1; j++)
+        {
+            for (int i = i0; i <= i1; i++)
+            {
+                f(i, j);
+            }
+        }
+    }
+
+public:
+    [[nodiscard]]
+    json to_json() const
+    {
+        if (!valid()) return json::object();
+
+        json j = {
+             {"id", tf->id[slot]},
+             {"x", (int)pos().x},
+             {"y", (int)pos().y},
+             {"scale", round_to_precision(scale(), 4)},
+             {"rotate", round_to_precision(rotate(), 4)},
+             {"flip_horizontal", (bool)flip()},
+             {"alpha", round_to_precision(alpha(), 2)},
+             {"spacing_x", round_to_precision(spacing_x, 1)},
+             {"spacing_y", round_to_precision(spacing_y, 1)},
+             {"stagger", round_to_precision(stagger, 4)},
+             {"jitter", round_to_precision(jitter, 1)},
+             {"rotate_jitter", round_to_precision(rotate_jitter, 2)},
+             {"seed", seed},
+             {"type", type_name()}
+        };
+
+        if (!full_path.empty())
+        {
+            j["image_name"] = name;
+            j["image_full_path"] = full_path;
+        }
+        else
+        {
+            j["text"] = text;
+            j["font_name"] = font_name;
+            j["font_size"] = round_to_precision(font_size, 1);
+            j["font_color"] = int_to_hex_color(font_color);
+        }
+
+        return j;
+    }
+
+    [[nodiscard]]
+    bool valid() const
+    {
+        return (bool)surface && !deleted();
+    }
+
+    // Hit test against the grid as drawn in the overlay window of `area`
+    [[nodiscard]]
+    bool hit_test(SDL_FPoint pt, const SDL_Rect &area) const
+    {
+        float sx, sy;
+        bool hit = false;
+
+        if (!valid()) return false;
+
+        tile_spacing(*tf, area, sx, sy);
+        for_tiles(*tf, pos(), sx, sy, pt.x, pt.y, pt.x, pt.y, [&](int i, int j)
+        {
+            SDL_FPoint center, local;
+            float angle;
+
+            if (hit) return;
+
+            tile_transform(*tf, i, j, pos(), sx, sy, center, angle);
+            if (SceneTransforms::obb_contains(center, extent(), scale(), angle, pt, &local))
+            {
+                Uint8 a = 255;
+
+                if (!full_path.empty())
+                {
+                    // Image tiles only hit on opaque pixels
+                    std::lock_guard lock(asset_cache.mutex);
+                    int xoff = flip() ? extent().w - (int)local.x - 1 : (int)local.x;
+                    SDL_ReadSurfacePixel(surface, xoff, (int)local.y, nullptr, nullptr, nullptr, &a);
+                }
+                hit = a > 50;
+            }
+        });
+
+        return hit;
+    }
+
+    bool handle_event(const SDL_Event* event, int &needs_update, AppContext *app)
+    {
+        if (!app->layout_mode || !valid()) return false;
+
+        if (event->type == SDL_EVENT_MOUSE_WHEEL)
+        {
+            SDL_FPoint pt(event->wheel.mouse_x, event->wheel.mouse_y);
+
+            if (hit_test(pt, overlay_area_at(app, pt)))
+            {
+                if (SDL_GetModState() & SDL_KMOD_CTRL)
+                {
+                    // Rotate tiles
+                    rotate() += (float) (5 * app->wheel_net_steps);
+                }
+                else if (SDL_GetModState() & SDL_KMOD_SHIFT)
+                {
+                    // Scale pattern (around the cursor)
+                    float dScale = powf(1.1f, event->wheel.y);
+                    SDL_FPoint p = pos();
+                    scale() *= dScale;
+                    p.x += (float) ((p.x - pt.x) * (dScale - 1.0));
+                    p.y += (float) ((p.y - pt.y) * (dScale - 1.0));
+                    set_pos(p);
+                }
+                else
+                {
+                    // Change pattern alpha
+                    alpha() = SDL_clamp(alpha() + (float)app->wheel_net_steps * (5.f / 255.f), 0.f, 1.f);
+                }
+                needs_update = UPDATE_SETTINGS_CHANGED;
+                return true;
+            }
+        }
+
+        else if (event->type == SDL_EVENT_MOUSE_BUTTON_DOWN)
+        {
+            SDL_FPoint pt(event->motion.x, event->motion.y);
+
+            if (hit_test(pt, overlay_area_at(app, pt)))
+            {
+                // Dragging any tile moves the whole grid
+                app->mouse_capture = handle();
+                app->dragging_origin = pt;
+                app->dragging_offset = SDL_FPoint(
+                    pt.x - pos().x,
+                    pt.y - pos().y
+                );
+                return true;
+            }
+        }
+
+        else if (event->type == SDL_EVENT_MOUSE_BUTTON_UP)
+        {
+            if (app->mouse_capture == handle())
+            {
+                SDL_FPoint p = app->dragging_origin;
+                p.x -= app->dragging_offset.x;
+                p.y -= app->dragging_offset.y;
+                set_pos(p);
+                app->mouse_capture = {};
+                app->dragging_offset = {0, 0};
+                needs_update = UPDATE_SETTINGS_CHANGED;
+                return true;
+            }
+        }
+
+        else if (event->type == SDL_EVENT_MOUSE_MOTION)
+        {
+            SDL_FPoint pt(event->motion.x, event->motion.y);
+
+            if (app->mouse_capture == handle())
+            {
+                app->dragging_origin = pt;
+                needs_update = UPDATE_VIEW_CHANGED;
+                return true;
+            }
+            else
+            {
+                if (!app->mouse_capture && hit_test(pt, overlay_area_at(app, pt)))
+                {
+                    SDL_SetCursor(app->handCursor);
+                    return true;
+                }
+            }
+        }
+
+        else if (event->type == SDL_EVENT_KEY_DOWN)
+        {
+            SDL_FPoint pt = cursor_position();
+
+            if (event->key.key == SDLK_F)
+            {
+                if (hit_test(pt, overlay_area_at(app, pt)))
+                {
+                    flip() = !flip();
+                    needs_update = UPDATE_SETTINGS_CHANGED;
+                    return true;
+                }
+            }
+            else if (event->key.key == SDLK_DELETE)
+            {
+                if (hit_test(pt, overlay_area_at(app, pt)))
+                {
+                    deleted() = true;
+                    needs_update = UPDATE_SETTINGS_CHANGED;
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    void draw(const SceneTransforms &view, const SDL_FPoint &pt, float alpha, const OverlayWindow &overlay, QuadBatch &batch) const
+    {
+        float sx, sy;
+
+        if (!surface || !overlay.renderer) return;
+
+        const SDL_Rect &ext = view.extent[slot];
+        float tile_alpha = BLENDED_ALPHA_FLOAT(view.alpha[slot], alpha);
+        SDL_Texture *tex = asset_cache.texture(this, 0, surface, overlay.renderer);
+
+        if (!tex) return;
+
+        // (Spacing is only widened for very dense grids, by the window's current area)
+        tile_spacing(view, overlay.area, sx, sy);
+        for_tiles(view, pt, sx, sy, 0.f, 0.f, (float)overlay.area.w, (float)overlay.area.h, [&](int i, int j)
+        {
+            SDL_FPoint center;
+            float angle;
+
+            tile_transform(view, i, j, pt, sx, sy, center, angle);
+            batch.add(
+                    tex,
+                    center.x - (float)ext.x, center.y - (float)ext.y,
+                    (float)ext.w, (float)ext.h,
+                    view.scale[slot], angle,
+                    view.flip[slot], false,
+                    tile_alpha);
+        });
+    }
+};
+
+
+// Data-oriented scene: transforms as structure-of-arrays, content in per-type component arrays.
+// Draw order is the slot order. std::deque keeps component addresses stable when growing.
+struct SceneStore
+{
+    SceneTransforms transforms;
+
+    std::deque<LineObject> lines;
+    std::deque<Signature> signatures;
+    std::deque<Image> images;
+    std::deque<AnimatedGif> gifs;
+    std::deque<TiledPattern> patterns;
+
+    std::unordered_map<Uint32, Uint32> slot_by_id;
+    Uint32 next_id = 1;
+
+    // Shared by the asset loads still running for this scene, cancelled when the scene goes
+    CancelToken loads = make_cancel_token();
+
+    ~SceneStore()
+    {
+        *loads = true;
+    }
+
+    [[nodiscard]]
+    Uint32 size() const { return transforms.size(); }
+
+    // Creates a component of type `T`, reusing `id` (from the settings file) if it is still free
+    template <class T, class... Args>
+    T &emplace(std::deque<T> &components, ObjectType type, Uint32 id, Args&&... args)
+    {
+        if (id == 0 || slot_by_id.contains(id))
+        {
+            id = next_id;
+        }
+        next_id = SDL_max(next_id, id + 1);
+
+        Uint32 slot = transforms.push(id, type, (Uint32)components.size());
+        slot_by_id[id] = slot;
+
+        return components.emplace_back(&transforms, slot, std::forward<Args>(args)...);
+    }
+
+    // Removes the last created object (of type `T`) again, e.g. if it failed to load
+    template <class T>
+    void discard_last(std::deque<T> &components)
+    {
+        slot_by_id.erase(transforms.id.back());
+        transforms.pop();
+        components.pop_back();
+    }
+
+    // Calls `f` with the concrete component of `slot` (type-tagged dispatch)
+    template <class F>
+    decltype(auto) visit(Uint32 slot, F &&f)
+    {
+        Uint32 index = transforms.index[slot];
+
+        switch (transforms.type[slot])
+        {
+            case OBJECT_SIGNATURE:
+                return f(signatures[index]);
+            case OBJECT_IMAGE:
+                return f(images[index]);
+            case OBJECT_ANIMATED_GIF:
+                return f(gifs[index]);
+            case OBJECT_TILED_PATTERN:
+                return f(patterns[index]);
+            case OBJECT_LINES:
+            default:
+                return f(lines[index]);
+        }
+    }
+
+    [[nodiscard]]
+    LineObject *line_object()
+    {
+        return lines.empty() ? nullptr : &lines.front();
+    }
+
+    [[nodiscard]]
+    bool valid(Uint32 slot)
+    {
+        return visit(slot, [](auto &obj) { return obj.valid(); });
+    }
+
+    [[nodiscard]]
+    json to_json(Uint32 slot)
+    {
+        return visit(slot, [](auto &obj) { return obj.to_json(); });
+    }
+
+    bool handle_event(Uint32 slot, const SDL_Event *event, int &needs_update, AppContext *app)
+    {
+        return visit(slot, [&](auto &obj) { return obj.handle_event(event, needs_update, app); });
+    }
+};
+
+
+// What a frame shows, captured by the main thread (events, animation timing) and drawn by the render thread.
+// Transforms and settings are copied, the components are referenced: their surfaces are read under
+// `asset_cache.mutex`, and the line layer is drawn with the copied style. (Components stay where they are
+// until the scene goes, after the render thread has stopped.)
+struct SceneSnapshot
+{
+    SceneTransforms view;        // The dragged object at its drag position
+    vector<void *> objects;      // Component of each slot (nullptr: deleted or not loaded)
+    vector<int> frames;          // Frame of each animated GIF
+    const LineObject *line_object = nullptr;
+    LineObject::Style lines = {};
+    float alpha = 1.f;
+    bool hidden = false;
+    bool layout_mode = false;
+    bool latency_hud = false;
+    Uint32 drag_id = 0;          // Object drawn over the drag background (0: no drag)
+    Uint64 scene_version = 0;    // See `AppContext::scene_version`
+    Uint64 serial = 0;
+
+    // (Reuses the buffers of the snapshot it replaces)
+    void capture(const AppContext *app)
+    {
+        SceneStore *scene = app->scene;
+
+        view = scene->transforms;
+        objects.assign(view.size(), nullptr);
+        frames.assign(view.size(), -1);
+        for (Uint32 slot = 0; slot < view.size(); slot++)
+        {
+            if (view.deleted[slot] || !scene->valid(slot)) continue;
+
+            objects[slot] = scene->visit(slot, [](auto &obj) { return (void *)&obj; });
+            if (view.type[slot] == OBJECT_ANIMATED_GIF)
+            {
+                frames[slot] = scene->gifs[view.index[slot]].current_frame;
+            }
+        }
+
+        drag_id = 0;
+        if (app->mouse_capture && app->mouse_capture.slot < view.size() && !app->hidden)
+        {
+            SDL_FPoint pt = object_position(app, app->mouse_capture.slot);
+            view.x[app->mouse_capture.slot] = pt.x;
+            view.y[app->mouse_capture.slot] = pt.y;
+            drag_id = app->mouse_capture.id;
+        }
+
+        line_object = scene->line_object();
+        if (line_object) lines = line_object->style();
+        alpha = app->alpha;
+        hidden = app->hidden;
+        layout_mode = app->layout_mode;
+        latency_hud = app->latency_stats;
+        scene_version = app->scene_version;
+    }
+
+    [[nodiscard]]
+    bool in_view(Uint32 slot, const SDL_Rect &area) const
+    {
+        return objects[slot] && view.in_view(slot, {view.x[slot], view.y[slot]}, area);
+    }
+
+    // Queues `slot` at `pt` (window coordinates)
+    void draw(Uint32 slot, const SDL_FPoint &pt, const OverlayWindow &overlay, QuadBatch &batch) const
+    {
+        void *object = objects[slot];
+
+        if (!object) return;
+        if (view.type[slot] == OBJECT_LINES)
+        {
+            static_cast<const LineObject *>(object)->draw(lines, alpha, overlay, batch);
+            return;
+        }
+
+        std::lock_guard lock(asset_cache.mutex);
+        switch (view.type[slot])
+        {
+            case OBJECT_SIGNATURE:
+                static_cast<const Signature *>(object)->draw(view, pt, alpha, overlay, batch);
+                break;
+            case OBJECT_IMAGE:
+                static_cast<const Image *>(object)->draw(view, pt, alpha, overlay, batch);
+                break;
+            case OBJECT_ANIMATED_GIF:
+                static_cast<AnimatedGif *>(object)->draw(view, frames[slot], pt, alpha, overlay, batch);
+                break;
+            case OBJECT_TILED_PATTERN:
+                static_cast<const TiledPattern *>(object)->draw(view, pt, alpha, overlay, batch);
+                break;
+            default:
+                break;
+        }
+    }
+};
+
+
+// Draws and presents all windows on a thread of its own, from the latest scene snapshot the main thread
+// has published. So event handling never waits for a present (each window waits for its vsync) or for
+// a line raster, and the render thread never waits for the main thread: it skips to the newest snapshot.
+// The renderers belong to this thread while it runs (SDL wants a renderer used by one thread only).
+class RenderThread
+{
+    TripleBuffer<SceneSnapshot> snapshots;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool woken = false;     // A snapshot was published (guarded by `mutex`)
+    bool stopping = false;
+
+public:
+    ~RenderThread()
+    {
+        stop();
+    }
+
+    // Snapshot to capture the scene into (main thread)
+    SceneSnapshot &write_buffer() { return snapshots.write_buffer(); }
+
+    // Hands the snapshot over, it's drawn in place while the thread isn't running (startup)
+    void publish(AppContext *app)
+    {
+        snapshots.publish();
+        if (!thread.joinable())
+        {
+            snapshots.update();
+            draw_frame(app, snapshots.read_buffer(), false);
+            return;
+        }
+        {
+            std::lock_guard lock(mutex);
+            woken = true;
+        }
+        wake.notify_one();
+    }
+
+    void start(AppContext *app)
+    {
+        // (A GL context is current on one thread at a time, the renderers make theirs current when used)
+        if (SDL_GL_GetCurrentContext()) SDL_GL_MakeCurrent(app->window, nullptr);
+
+        stopping = false;
+        thread = std::thread([this, app] { run(app); });
+    }
+
+    // Joins the thread after the frame it is drawing, the renderers return to the calling thread
+    void stop()
+    {
+        if (!thread.joinable()) return;
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        thread.join();
+    }
+
+private:
+    void run(AppContext *app)
+    {
+        bool rastering = false;  // A line re-raster is in progress, it goes on in the next frames
+
+        for (;;)
+        {
+            {
+                std::unique_lock lock(mutex);
+                wake.wait(lock, [&] { return stopping || woken || rastering; });
+                if (stopping) break;
+                woken = false;
+            }
+            snapshots.update();
+            rastering = draw_frame(app, snapshots.read_buffer(), rastering);
+        }
+        if (SDL_GL_GetCurrentContext()) SDL_GL_MakeCurrent(app->window, nullptr);
+    }
+};
+
+RenderThread render_thread;
+
+
+SDL_AppResult app_init_failed()
+{
+    SDL_LogError(
+        SDL_LOG_CATEGORY_CUSTOM,
+        "Error %s",
+        SDL_GetError()
+    );
+    return SDL_APP_FAILURE;
+}
+
+
+SDL_AppResult SDL_AppInit(
+    void** appstate,
+    int argc,
+    char* argv[]
+)
+{
+    json objects;
+    auto *app = new AppContext;
+    *appstate = app;
+    app->startup.begin();
+
+    // Command line
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if ((arg == "--benchmark" || arg == "--benchmark-baseline") && i + 1 < argc)
+        {
+            app->benchmark_record = (arg == "--benchmark-baseline");
+            app->benchmark_file = argv[++i];
+        }
+        else if (arg == "--startup-report")
+        {
+            app->startup_report = true;
+        }
+    }
+
+    // Get the base path
+    app->base_path = SDL_GetBasePath();
+    if (app->base_path.empty())
+    {
+        return app_init_failed();
+    }
+    asset_cache.add_embedded(app->base_path);
+    app->startup.phase("base path, embedded assets");
+
+    // Init SDL
+    if (!SDL_Init(SDL_INIT_VIDEO))
+    {
+        return app_init_failed();
+    }
+    JobSystem::main_event = SDL_RegisterEvents(1);
+    job_system.start(SDL_GetNumLogicalCPUCores() - 1);
+    app->startup.phase("SDL_Init, job system");
+
+    // Init TTF
+    if (!TTF_Init())
+    {
+        return app_init_failed();
+    }
+    app->startup.phase("TTF_Init");
+
+    // Create hand cursor
+    app->handCursor = SDL_CreateSystemCursor(SDL_SYSTEM_CURSOR_POINTER);
+    if (!app->handCursor)
+    {
+        return app_init_failed();
+    }
+    app->startup.phase("cursor");
+
+    // Read settings
+    if (!app->benchmark_file.empty())
+    {
+        // Benchmarks run a fixed scene (the default objects) in a 1920x1080 window on the software
+        // renderer, so results are comparable between runs
+        app->screen_rect_init = {0, 0, 1920, 1080};
+        app->all_displays = false;
+        app->render_driver = "software";
+    }
+    else if (!settings_read(app, objects))
+    {
+        return app_init_failed();
+    }
+    app->startup.phase("settings_read");
+
+    // Update screen metrics
+    update_screen_metrics(app);
+    app->startup.phase("screen metrics");
+
+    // Create the primary overlay window, scene coordinates are relative to it
+    ScreenObject::scene_origin = {(float)app->work_area.x, (float)app->work_area.y};
+    app->overlays.emplace_back();
+    if (!overlay_window_create(app, app->overlays.back(), app->work_area))
+    {
+        return app_init_failed();
+    }
+    app->startup.phase("primary window");
+
+    // (Calibrates the backends on the first start on a machine)
+    const char *render_driver = render_driver_select(app, objects);
+    app->startup.phase("renderer selection, calibration");
+
+    if (!overlay_renderer_create(app, app->overlays.back(), render_driver))
+    {
+        return app_init_failed();
+    }
+    SDL_Log("Renderer: %s", SDL_GetRendererName(app->overlays[0].renderer));
+    app->window = app->overlays[0].window;
+    app->renderer = app->overlays[0].renderer;
+    app->hwnd = app->overlays[0].hwnd;
+
+    // All surfaces are produced in the renderer's preferred format
+    asset_cache.select_pixel_format(app->renderer);
+    app->startup.phase("primary renderer");
+
+    // Cover the other displays too
+    if (app->all_displays)
+    {
+        overlays_add_displays(app);
+    }
+    app->startup.phase("other displays");
+
+    // Create the scene and the line object
+    app->scene = new SceneStore;
+    screen_objects_add_lines(app);
+
+    // Initialize screen objects
+    init_screen_objects(app, objects);
+    app->startup.phase("scene objects");
+
+    // If no screen objects defined in settings file, create two default objects
+    if (app->scene->size() <= 1)
+    {
+        if (!screen_objects_add_defaults(app))
+        {
+            return app_init_failed();
+        }
+        app->startup.phase("default objects");
+    }
+
+    if (!app->benchmark_file.empty())
+    {
+        return benchmark_main(app) ? SDL_APP_SUCCESS : SDL_APP_FAILURE;
+    }
+
+    // print some information about the window
+    {
+        int width, height, bbwidth, bbheight;
+        SDL_GetWindowSize(app->window, &width, &height);
+        SDL_GetWindowSizeInPixels(app->window, &bbwidth, &bbheight);
+        SDL_Log("Window size: %ix%i", width, height);
+        SDL_Log("Backbuffer size: %ix%i", bbwidth, bbheight);
+        if (width != bbwidth)
+        {
+            SDL_Log("This is a highdpi environment.");
+        }
+    }
+
+    SDL_Log("Application started successfully!");
+
+    // draw
+    draw(app);
+    app->startup.phase("first draw");
+
+    if (app->startup_report)
+    {
+        startup_report(app);
+        return SDL_APP_SUCCESS;
+    }
+
+    for (const OverlayWindow &overlay : app->overlays)
+    {
+        SDL_ShowWindow(overlay.window);
+    }
+
+    // From here on the windows are drawn on the render thread
+    render_thread.start(app);
+
+    return SDL_APP_CONTINUE;
+}
+
+
+void SDL_AppQuit(void* appstate, [[maybe_unused]] SDL_AppResult result)
+{
+    auto* app = (AppContext*)appstate;
+
+    if (result == SDL_APP_SUCCESS && app && app->benchmark_file.empty() && !app->startup_report)
     {
-        full_path = (base_path / name).string();
-        init(x, y, name, full_path, scale_by, rotate_by, flip_horizontal, alpha, cache_frames);
+        settings_write(app);
+    }
+    if (app && app->latency_stats)
+    {
+        latency_write(app);
     }
 
-    AnimatedGif(json &j, const SDL_Renderer *renderer)
-    : Image(-1, -1, renderer),
-      gif((GifFileType*)nullptr)
+    if (app)
     {
-        try
+        render_thread.stop();
+        for (const OverlayWindow &overlay : app->overlays)
         {
-            init(
-                j["x"], j["y"],
-                j.value("image_name", ""),
-                j.value("image_full_path", ""),
-                j.value("scale", 1.f),
-                j.value("rotate", 0.f),
-                j.value("flip_horizontal", false),
-                j.value("alpha", 1.f),
-                j.value("cache_frames", true));
+            SDL_HideWindow(overlay.window);
         }
-        catch (const std::exception &e)
+
+        // Textures go before their renderers
+        free_screen_objects(app);
+        job_system.stop();
+        asset_cache.clear();
+
+        for (OverlayWindow &overlay : app->overlays)
         {
-            SDL_Log("Error creating image: %s", e.what());
+            overlay_window_destroy(overlay);
         }
+        SDL_DestroyCursor(app->handCursor);
+
+        delete app;
     }
 
-    [[nodiscard]]
-    const char* type_name() const override {return "AnimatedGif";}
+    TTF_Quit();
+
+    SDL_Log("Application quit successfully!");
+    SDL_Quit();
+}
+
+
+SDL_AppResult SDL_AppIterate(void *appstate)
+{
+    auto* app = (AppContext*)appstate;
+    int timeout = -1;
+    Uint64 ticks = SDL_GetTicks();
 
-    ~AnimatedGif() override
+    if (app->app_quit != SDL_APP_CONTINUE) return app->app_quit;
+
+    if (app->needs_redraw || app->drag_moved)
     {
-        invalidate(true);
-        SDL_DestroyTexture(texture);
-        SDL_DestroySurface(surface);
-        if (gif) DGifCloseFile(gif, nullptr);
+        draw(app);
     }
 
-protected:
-    void init(
-        float x, float y,
-        const string &name,
-        const string &full_path,
-        float scale_by,
-        float rotate_by,
-        bool flip_horizontal,
-        float alpha,
-        bool cache_frames)
+    // Deadlines of the dash jitter and the animations, in ms from now.
+    // Once one is due, all others within the timer slack are served with it, so the group
+    // is published once (the render thread presents it at the next vblank).
+    auto *line_object = app->scene->line_object();
+    bool jitter = line_object && line_object->dashed && line_object->dashed_gap > 0 && line_object->width > 0 && !app->hidden;
+    bool animate = app->have_animations && !app->hidden;
+    auto gif_due = [ticks](const AnimatedGif &gif)
     {
-        this->name = name;
-        this->full_path = full_path;
-        pos.x = x;
-        pos.y = y;
-        scale = scale_by;
-        rotate = rotate_by;
-        this->flip_horizontal = flip_horizontal;
-        latest_ticks = SDL_GetTicks() + dist(gen) % 500;
-        frame_count = 0;
-        current_frame = 0;
-        recent_disposal = DISPOSAL_UNSPECIFIED;
-        this->alpha = alpha;
-        this->cache_frames = cache_frames;
-        this->previous_frame_rect = {0, 0, 0, 0};
+        return (int)((Sint64)gif.latest_ticks + gif.frame_info[gif.current_frame].delay_ms - (Sint64)ticks);
+    };
 
-        if (!renderer) return;
+    int jitter_due = jitter ? app->idle_delay_ms - (int)(Sint64)(ticks - app->idle_ticks) : SDL_MAX_SINT32;
+    int earliest = jitter_due;
+    if (animate)
+    {
+        for (const auto &gif : app->scene->gifs)
+        {
+            // (Finished and off-screen GIFs are not scheduled)
+            if (gif.valid() && !gif.finished && object_on_screen(app, gif.slot))
+            {
+                earliest = SDL_min(earliest, gif_due(gif));
+            }
+        }
+    }
+    int horizon = (earliest <= 0) ? app->timer_slack_ms : 0;
 
-        gif = DGifOpenFileName(full_path.c_str(), nullptr);
-        if (!gif)
+    if (jitter)
+    {
+        if (jitter_due <= horizon)
         {
-            SDL_Log("Error loading \"%s\":\n   %s", name.c_str(), SDL_GetError());
+            app->idle_ticks = ticks;
+            app->needs_redraw = true;
         }
         else
         {
-            GraphicsControlBlock gcb;
-
-            DGifSlurp(gif);
-            frame_count = gif->ImageCount;
-            for (int i = 0; i < frame_count; i++)
-            {
-                frame_info_t info {
-                    .delay_ms = 100,
-                    .transparent_color_index = NO_TRANSPARENT_COLOR,
-                    .disposal_mode = DISPOSAL_UNSPECIFIED,
-                    .texture_outdated = true,
-                    .texture = (SDL_Texture *)nullptr
-                };
+            timeout = jitter_due;
+        }
+    }
 
-                SavedImage *frame = &gif->SavedImages[i];
-                for (int j = 0; j < frame->ExtensionBlockCount; j++)
-                {
-                    ExtensionBlock *ext = &frame->ExtensionBlocks[j];
-                    if (ext && ext->Function == GRAPHICS_EXT_FUNC_CODE)
-                    {
-                        if (GIF_OK == DGifExtensionToGCB(ext->ByteCount, ext->Bytes, &gcb))
-                        {
-                            info.delay_ms = gcb.DelayTime * 10;
-                            info.transparent_color_index = gcb.TransparentColor;
-                            info.disposal_mode = gcb.DisposalMode;
-                            break;
-                        }
-                    }
-                }
+    if (animate)
+    {
+        for (auto &gif : app->scene->gifs)
+        {
+            // Off-screen GIFs are paused, once in view again they are overdue and `catch_up()` seeks
+            // to the frame due by then
+            if (!gif.valid() || gif.finished || !object_on_screen(app, gif.slot)) continue;
 
-                frame_info.push_back(info);
+            int due = gif_due(gif);
+            if (due <= horizon)
+            {
+                // (Served early by up to the slack, the pace is kept from the due time)
+                if (!gif.catch_up(ticks + SDL_max(0, due))) continue;
+                app->needs_redraw = true;
             }
-
-            surface = SDL_CreateSurface(gif->SWidth, gif->SHeight, SDL_PIXELFORMAT_RGBA8888);
-            if (surface)
+            else
             {
-                SDL_ClearSurface(surface, 0, 0, 0, 0);
+                timeout = (timeout < 0) ? due : SDL_min(timeout, due);
             }
-            render_frame(const_cast<SDL_Renderer*>(renderer));
-            extent.w = gif->SWidth;
-            extent.h = gif->SHeight;
-            extent.x = extent.w / 2;
-            extent.y = extent.h / 2;
         }
     }
 
-public:
-    [[nodiscard]]
-    json to_json() const override
+    if (!app->needs_redraw && !app->drag_moved)
     {
-        if (!valid()) return json::object();
-
-        return json( {
-             {"x", (int)pos.x},
-             {"y", (int)pos.y},
-             {"image_name", name},
-             {"image_full_path", full_path},
-             {"scale", round_to_precision(scale, 4)},
-             {"rotate", round_to_precision(rotate, 4)},
-             {"flip_horizontal", (bool)flip_horizontal},
-             {"alpha", round_to_precision(alpha, 2)},
-             {"cache_frames", (bool)cache_frames},
-             {"type", type_name()}
-        });
+        // Wait for next event with timeout (timeout==-1 means "no timeout")
+        SDL_WaitEventTimeout(nullptr, timeout);
+        // SDL_Log("timeout: %i", timeout);
     }
 
-    [[nodiscard]]
-    bool valid() const override
+    return app->app_quit;
+}
+
+
+SDL_AppResult SDL_AppEvent(void *appstate, SDL_Event* event)
+{
+    auto* app = (AppContext*)appstate;
+
+    // (Arrival of the oldest event of a burst)
+    Uint64 arrival_ns = event->common.timestamp;
+    const char *latency_type = app->latency_stats ? latency_event_type(event, app) : nullptr;
+
+    // Queued bursts of mouse motion, wheel and key repeat events are handled as one event,
+    // with a single redraw (and content invalidation) for the net change
+    int burst = event_coalesce_burst(event, app->wheel_net_steps);
+    if (event->type == SDL_EVENT_KEY_DOWN && burst % 2 == 0 && key_toggles(event->key.key))
     {
-        return (bool)surface && !deleted;
+        // (Toggled back and forth)
+        return app->app_quit;
     }
 
-    bool handle_event(const SDL_Event* event, int &needs_update, AppContext *app) override
-    {
-        bool result = valid() && Image::handle_event(event, needs_update, app);
+    // Mouse positions of all windows are handled in scene coordinates
+    overlay_event_to_scene(app, event);
 
-        if (needs_update == UPDATE_SETTINGS_CHANGED)
-        {
-            invalidate();
-        }
+    screen_objects_handle_event(event, app);
 
-        return result;
+    if (event->type == SDL_EVENT_QUIT)
+    {
+        app->app_quit = SDL_APP_SUCCESS;
     }
 
-    void draw(const SDL_FPoint &pt, float alpha, const SDL_Renderer *renderer) const override
+    else if (JobSystem::main_event && event->type == JobSystem::main_event)
     {
-        // If the GIF is not valid or the renderer is not available, do nothing.
-        if (!valid()) return;
+        // Results of pool tasks, e.g. decoded images
+        if (job_system.run_continuations()) app->needs_redraw = true;
+    }
 
-        // Calculate the position and dimensions of the GIF on the screen.
-        float x = pt.x - (float)extent.x;
-        float y = pt.y - (float)extent.y;
-        float w = (float)extent.w;
-        float h = (float)extent.h;
+    else if (event->type == SDL_EVENT_WINDOW_MINIMIZED)
+    {
+        SDL_RestoreWindow(SDL_GetWindowFromID(event->window.windowID));
+        app->needs_redraw = true;
+    }
 
-        // Render the current frame of the GIF with the specified transformations.
-        render_transformed_texture(
-                texture,
-                x, y, w, h,
-                scale, rotate,
-                flip_horizontal, false,
-                BLENDED_ALPHA_FLOAT(this->alpha, alpha),
-                renderer);
+    else if (event->type == SDL_EVENT_WINDOW_RESTORED)
+    {
+        app->needs_redraw = true;
     }
 
-    // The render_frame function is the core of the animated GIF rendering.
-    // It is responsible for decoding the current frame, handling disposal methods,
-    // and updating the texture that is displayed on the screen.
-    void render_frame(const SDL_Renderer *renderer)
+    else if (event->type == SDL_EVENT_WINDOW_FOCUS_GAINED)
     {
-        SavedImage *frame;
-        int left, top, width, height;
-        const ColorMapObject *color_map;
-        const Uint8 *raster_bits;
-        int bg_color;
-        frame_info_t *frame_info = &this->frame_info[current_frame];
-        int transparent_color;
-        Uint32 *addr;
+        app->needs_redraw = true;
+    }
 
-        // If the GIF is not valid or the renderer is not available, do nothing.
-        if (!valid() || !renderer) return;
+    else if (event->type == SDL_EVENT_WINDOW_FOCUS_LOST)
+    {
+        app->mouse_capture = {};
+    }
 
-        // If the texture for the current frame is already cached, just use it.
-        if (!frame_info->texture_outdated)
+    else if (event->type == SDL_EVENT_MOUSE_WHEEL)
+    {
+        if (app->layout_mode)
         {
-            texture = frame_info->texture;
-            recent_disposal = frame_info->disposal_mode;
-            return;
+            app->alpha = SDL_clamp(app->alpha + (float)app->wheel_net_steps * 5.f / 255.f, 0.f, 1.f);
+            app->is_virgin = false;
+            app->needs_redraw = true;
         }
+    }
 
-        // If the surface is not valid or the pixel format is not RGBA8888, do nothing.
-        if (!surface || surface->format != SDL_PIXELFORMAT_RGBA8888) return;
-
-        // Prepare canvas for the current frame
-        if (!gif || !gif->SavedImages) return;
-        frame = &gif->SavedImages[current_frame];
-        bg_color = gif->SBackGroundColor;
-        raster_bits = frame->RasterBits;
-        if (!raster_bits) return;
-        color_map = frame->ImageDesc.ColorMap ? frame->ImageDesc.ColorMap : gif->SColorMap;
-        if (!color_map) return;
-
-        // Handle the disposal method of the previous frame.
-        switch (recent_disposal)
+    else if (event->type == SDL_EVENT_MOUSE_MOTION)
+    {
+        if (app->layout_mode)
         {
-            case DISPOSE_BACKGROUND:
-            {
-                // Clear the area of the previous frame to the background color.
-                if (bg_color == NO_TRANSPARENT_COLOR || bg_color < color_map->ColorCount)
-                {
-                    SDL_FillSurfaceRect(surface, &previous_frame_rect, 0);
-                }
-                else
-                {
-                    GifColorType *color = &color_map->Colors[bg_color];
-                    const SDL_PixelFormatDetails* format_details = SDL_GetPixelFormatDetails(surface->format);
-                    Uint32 mapped_color = SDL_MapRGBA(
-                            format_details,
-                            nullptr,
-                            color->Red,
-                            color->Green,
-                            color->Blue,
-                            255);
-                    SDL_FillSurfaceRect(surface, &previous_frame_rect, mapped_color);
-                }
-                break;
-            }
-            case DISPOSE_DO_NOT:
-                // Do nothing, the previous frame is kept.
-                break;
-            case DISPOSAL_UNSPECIFIED:
-            default: // DISPOSE_NONE
-                // Do nothing, just overwrite the previous frame.
-                break;
+            SDL_SetCursor(SDL_GetDefaultCursor());
         }
+    }
 
-        // Get the dimensions and position of the current frame.
-        left = frame->ImageDesc.Left;
-        top = frame->ImageDesc.Top;
-        width = frame->ImageDesc.Width;
-        height = frame->ImageDesc.Height;
-
-        transparent_color = frame_info->transparent_color_index;
+    else if (event->type == SDL_EVENT_KEY_DOWN)
+    {
+        app->needs_redraw = true;
 
-        // Pre-calculate the palette colors for the current frame to optimize the rendering loop.
-        vector<Uint32> palette_colors(color_map->ColorCount);
-        const SDL_PixelFormatDetails* format_details = SDL_GetPixelFormatDetails(surface->format);
-        for (int i = 0; i < color_map->ColorCount; i++)
+        if (event->key.key == SDLK_LEFT)
         {
-            if (i == transparent_color) {
-                // Set the transparent color to have an alpha of 0 (values of R, G, B don't matter, since alpha is zero).
-                palette_colors[i] = 0;
-            } else {
-                // Set the other colors with an alpha of 255 (fully opaque).
-                palette_colors[i] = SDL_MapRGBA(
-                        format_details,
-                        nullptr,
-                        color_map->Colors[i].Red,
-                        color_map->Colors[i].Green,
-                        color_map->Colors[i].Blue,
-                        255);
-            }
+            app->alpha = SDL_max(0, app->alpha - (float)burst * 17.f / 255.f);
+            app->is_virgin = false;
         }
-
-        // Lock the surface to directly access the pixels.
-        SDL_LockSurface(surface);
-        // Iterate over the pixels of the current frame and update the surface.
-        for (int i = 0; i < height; i++)
+        else if (event->key.key == SDLK_RIGHT)
         {
-            addr = (Uint32*)(void*)((Uint8*)surface->pixels + (i + top) * surface->pitch) + left;
-            for (int j = 0; j < width; j++)
-            {
-                int color_index = *raster_bits++;
-                if (color_index < color_map->ColorCount)
-                {
-                    // Only draw the pixel if it is not transparent.
-                    Uint32 color = palette_colors[color_index];
-                    if (color) *addr = color;
-                }
-
-                addr++;
-            }
+            app->alpha = SDL_min(1.f, app->alpha + (float)burst * 17.f / 255.f);
+            app->is_virgin = false;
+        }
+        else if (event->key.key == SDLK_X)
+        {
+            app->app_quit = SDL_APP_SUCCESS;
+        }
+        else if ((event->key.key == SDLK_SPACE) or (event->key.key == SDLK_RETURN))
+        {
+            app->layout_mode = !app->layout_mode;
+            update_layout_mode(app);
+        }
+        else if (event->key.key == SDLK_H)
+        {
+            app->hidden = !app->hidden;
+            app->is_virgin = false;
+        }
+        else if (event->key.key == SDLK_V && SDL_GetModState() & SDL_KMOD_CTRL)
+        {
+            clipboard_insert(app);
+        }
+        else if (event->key.key == SDLK_T && app->layout_mode)
+        {
+            screen_objects_add_pattern(app);
+        }
+        else
+        {
+            app->needs_redraw = false;
         }
-        SDL_UnlockSurface(surface);
+    }
 
-        // Destroy the old texture and create a new one from the updated surface.
-        if (frame_info->texture)
+    else if (event->type == SDL_EVENT_DROP_TEXT)
+    {
+        if (event->drop.data)
         {
-            SDL_DestroyTexture(frame_info->texture);
-            frame_info->texture = (SDL_Texture *)nullptr;
-            frame_info->texture_outdated = true;
+            screen_objects_add_text(
+                    event->drop.x,
+                    event->drop.y,
+                    event->drop.data,
+                    app);
         }
-        texture = SDL_CreateTextureFromSurface(const_cast<SDL_Renderer*>(renderer), surface);
-        // If caching is enabled, store the new texture.
-        if (cache_frames)
+    }
+
+    else if (event->type == SDL_EVENT_DROP_FILE)
+    {
+        if (event->drop.data)
         {
-            frame_info->texture = texture;
-            frame_info->texture_outdated = false;
+            screen_objects_load_image(
+                    event->drop.x,
+                    event->drop.y,
+                    event->drop.data,
+                    app);
         }
+    }
 
-        // Store the rectangle of the current frame for the next iteration.
-        previous_frame_rect = {left, top, width, height};
-        // Store the disposal method of the current frame for the next iteration.
-        recent_disposal = frame_info->disposal_mode;
+    if (latency_type && (app->needs_redraw || app->drag_moved))
+    {
+        app->latency.input(latency_type, arrival_ns);
     }
 
-    void invalidate(bool remove = false)
+    return SDL_APP_CONTINUE;
+}
+
+
+// Hands an event (in scene coordinates) to the objects, the line object last.
+// A handled event is consumed (its type becomes SDL_EVENT_LAST), returns true then.
+bool screen_objects_handle_event(SDL_Event *event, AppContext *app)
+{
+    SceneStore *scene = app->scene;
+    LineObject *line_object = scene->line_object();
+
+    // Handle events for all objects except LineObject
+    for (Uint32 slot = 0; slot < scene->size(); slot++)
     {
-        for (auto info : frame_info)
+        if (scene->transforms.type[slot] == OBJECT_LINES) continue;
+
+        int needs_update = 0;
+        bool drag_motion = event->type == SDL_EVENT_MOUSE_MOTION && scene->transforms.id[slot] == app->mouse_capture.id;
+        if (scene->handle_event(slot, event, needs_update, app))
         {
-            info.texture_outdated = true;
-            if (remove)
+            if (drag_motion && needs_update == UPDATE_VIEW_CHANGED)
             {
-                SDL_DestroyTexture(info.texture);
-                if (texture == info.texture)
-                {
-                    texture = (SDL_Texture *)nullptr;
-                }
-                info.texture = (SDL_Texture *)nullptr;
+                // Drawn over the cached background
+                app->drag_moved = true;
             }
+            else if (needs_update >= UPDATE_VIEW_CHANGED)
+            {
+                app->needs_redraw = true;
+            }
+            if (needs_update >= UPDATE_SETTINGS_CHANGED)
+            {
+                app->is_virgin = false;
+            }
+            event->type = SDL_EVENT_LAST;
+            return true;
         }
     }
 
-};
-
-
-SDL_AppResult app_init_failed()
-{
-    SDL_LogError(
-        SDL_LOG_CATEGORY_CUSTOM,
-        "Error %s",
-        SDL_GetError()
-    );
-    return SDL_APP_FAILURE;
+    // If no other object handled the event, handle it for the LineObject
+    if (line_object)
+    {
+        int needs_update = 0;
+        if (line_object->handle_event(event, needs_update, app))
+        {
+            if (needs_update >= UPDATE_VIEW_CHANGED)
+            {
+                app->needs_redraw = true;
+            }
+            if (needs_update >= UPDATE_SETTINGS_CHANGED)
+            {
+                app->is_virgin = false;
+            }
+            event->type = SDL_EVENT_LAST;
+            return true;
+        }
+    }
+    return false;
 }
 
 
-SDL_AppResult SDL_AppInit(
-    void** appstate,
-    [[maybe_unused]] int argc,
-    [[maybe_unused]] char* argv[]
-)
+void update_screen_metrics(AppContext* app)
 {
-    json objects;
-    auto *app = new AppContext;
-    *appstate = app;
+    SDL_FPoint mouse;
+    SDL_GetMouseState(&mouse.x, &mouse.y);
+    SDL_Point pt((int)mouse.x, (int)mouse.y);
+    int displayIndex = SDL_GetDisplayForPoint(&pt);
 
-    // Get the base path
-    app->base_path = SDL_GetBasePath();
-    if (app->base_path.empty())
+    SDL_GetDisplayUsableBounds(displayIndex, &app->screen_rect);
+
+    if (app->screen_rect_init.x >= 0)
     {
-        return app_init_failed();
+        app->screen_rect.x = app->screen_rect_init.x;
     }
-
-    // Init SDL
-    if (!SDL_Init(SDL_INIT_VIDEO))
+    if (app->screen_rect_init.y >= 0)
     {
-        return app_init_failed();
+        app->screen_rect.y = app->screen_rect_init.y;
     }
-
-    // Init TTF
-    if (!TTF_Init())
+    if (app->screen_rect_init.w >= 0)
     {
-        return app_init_failed();
+        app->screen_rect.w = app->screen_rect_init.w;
+    }
+    if (app->screen_rect_init.h >= 0)
+    {
+        app->screen_rect.h = app->screen_rect_init.h;
     }
+    app->work_area = app->screen_rect;
 
-    // Create hand cursor
-    app->handCursor = SDL_CreateSystemCursor(SDL_SYSTEM_CURSOR_POINTER);
-    if (!app->handCursor)
+    // Not needed, since SDL_GetDisplayUsableBounds()
+    if (app->crop_bottom < 0)
     {
-        return app_init_failed();
+        APPBARDATA abd = {0};
+        abd.cbSize = sizeof(APPBARDATA);
+        if (SHAppBarMessage(ABM_GETTASKBARPOS, &abd)) 
+        {
+            RECT rc = abd.rc;
+            int height = 0;
+
+            if (abd.uEdge == ABE_BOTTOM || abd.uEdge == ABE_TOP) 
+            {
+                height = rc.bottom - rc.top;
+            }
+            app->crop_bottom = height;
+        }
     }
+    app->work_area.h -= app->crop_bottom;
 
-    // Read settings
-    if (!settings_read(app, objects))
+    app->center_x = (float) app->work_area.x + (float) app->work_area.w / 2.f;
+    app->center_y = (float) app->work_area.y + (float) app->work_area.h / 2.f;
+}
+
+
+void update_layout_mode(AppContext* app)
+{
+    for (const OverlayWindow &overlay : app->overlays)
     {
-        return app_init_failed();
+        if (!overlay.hwnd) continue;
+
+        if (app->layout_mode)
+        {
+            SetWindowLong(
+                overlay.hwnd,
+                GWL_EXSTYLE,
+                GetWindowLong(overlay.hwnd, GWL_EXSTYLE) & ~(WS_EX_LAYERED | WS_EX_TRANSPARENT)
+            );
+        }
+        else
+        {
+            SetWindowLong(
+                overlay.hwnd,
+                GWL_EXSTYLE,
+                GetWindowLong(overlay.hwnd, GWL_EXSTYLE) | WS_EX_LAYERED | WS_EX_TRANSPARENT
+            );
+        }
     }
+}
 
-    // Update screen metrics
-    update_screen_metrics(app);
 
-    // Create a window
-    app->window = SDL_CreateWindow(
+// Creates a (hidden) transparent overlay window covering `bounds` (desktop coordinates)
+bool overlay_window_create(AppContext *app, OverlayWindow &overlay, const SDL_Rect &bounds)
+{
+    overlay.area = {
+        bounds.x - app->work_area.x,
+        bounds.y - app->work_area.y,
+        bounds.w,
+        bounds.h
+    };
+
+    // (Renderer backends add SDL_WINDOW_OPENGL or SDL_WINDOW_VULKAN themselves if they need it)
+    overlay.window = SDL_CreateWindow(
         "dragon",
-        app->work_area.w, app->work_area.h,
+        bounds.w, bounds.h,
         SDL_WINDOW_ALWAYS_ON_TOP |
         SDL_WINDOW_OCCLUDED |
         SDL_WINDOW_TRANSPARENT |
@@ -1738,482 +5138,821 @@ SDL_AppResult SDL_AppInit(
         //SDL_WINDOW_FULLSCREEN |
         SDL_WINDOW_HIGH_PIXEL_DENSITY |
         SDL_WINDOW_HIDDEN |
-        SDL_WINDOW_OPENGL |
         0
     );
 
-    if (!app->window)
+    if (!overlay.window)
     {
-        return app_init_failed();
+        return false;
+    }
+    overlay.window_id = SDL_GetWindowID(overlay.window);
+    SDL_SetWindowPosition(overlay.window, bounds.x, bounds.y);
+
+    return true;
+}
+
+
+// Adds the renderer (`driver` == nullptr lets SDL choose) to an overlay window
+bool overlay_renderer_create(AppContext *app, OverlayWindow &overlay, const char *driver)
+{
+    // Add a renderer
+    overlay.renderer = SDL_CreateRenderer(overlay.window, driver);
+    if (!overlay.renderer && driver)
+    {
+        SDL_Log("Renderer \"%s\" not available: %s", driver, SDL_GetError());
+        overlay.renderer = SDL_CreateRenderer(overlay.window, nullptr);
+    }
+    if (!overlay.renderer)
+    {
+        return false;
     }
-    SDL_SetWindowPosition(app->window, app->work_area.x, app->work_area.y);
 
     // Retrieve the HWND from the SDL window
-    SDL_PropertiesID props = SDL_GetWindowProperties(app->window);
+    // (after creating the renderer, since a backend may have recreated the window)
+    SDL_PropertiesID props = SDL_GetWindowProperties(overlay.window);
     if (!props)
     {
-        return app_init_failed();
+        return false;
     }
-    else
+    overlay.hwnd = (HWND)SDL_GetPointerProperty(props, SDL_PROP_WINDOW_WIN32_HWND_POINTER, nullptr);
+    if (!overlay.hwnd)
     {
-        app->hwnd = (HWND)SDL_GetPointerProperty(props, SDL_PROP_WINDOW_WIN32_HWND_POINTER, nullptr);
-        if (!app->hwnd)
-        {
-            return app_init_failed();
-        }
-        else
-        {
-            update_layout_mode(app);
-        }
+        return false;
+    }
+    update_layout_mode(app);
+    SetLayeredWindowAttributes(overlay.hwnd, 0, 255, LWA_ALPHA);
+
+    // Displays may differ in pixel density, drawing stays in window coordinates
+    int width, height, bbwidth, bbheight;
+    SDL_GetWindowSize(overlay.window, &width, &height);
+    SDL_GetWindowSizeInPixels(overlay.window, &bbwidth, &bbheight);
+    overlay.pixel_scale = (width > 0 && bbwidth > 0) ? (float)bbwidth / (float)width : 1.f;
+    if (overlay.pixel_scale != 1.f)
+    {
+        SDL_SetRenderScale(overlay.renderer, overlay.pixel_scale, overlay.pixel_scale);
     }
-    SetLayeredWindowAttributes(app->hwnd, 0, 255, LWA_ALPHA);
 
-    // Add a renderer
-    app->renderer = SDL_CreateRenderer(app->window, nullptr);
-    if (!app->renderer)
+    // Prepare background
+    SDL_SetRenderVSync(overlay.renderer, SDL_RENDERER_VSYNC_ADAPTIVE);
+    SDL_SetRenderDrawBlendMode(overlay.renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(overlay.renderer, 0, 0, 0, 255); // Set black background
+    SDL_RenderClear(overlay.renderer);
+    SDL_RenderPresent(overlay.renderer); // Present first frame
+
+    return true;
+}
+
+
+// Selects the renderer backend: the `render_driver` setting overrides, otherwise the calibration
+// result cached for this machine is used, or the calibration is run (and cached).
+// Returns nullptr to let SDL choose.
+const char *render_driver_select(AppContext *app, json &objects)
+{
+    char name[MAX_COMPUTERNAME_LENGTH + 1];
+    DWORD name_len = sizeof(name);
+    string machine;
+
+    if (!app->render_driver.empty() && app->render_driver != "auto")
     {
-        return app_init_failed();
+        return app->render_driver.c_str();
     }
 
-    // Create the line object
-    screen_objects_add_lines(app);
+    if (GetComputerNameA(name, &name_len))
+    {
+        machine = name;
+    }
 
-    // Initialize screen objects
-    init_screen_objects(app, objects);
+    if (app->render_calibration.value("machine", "") != machine ||
+        !app->render_calibration.contains("driver"))
+    {
+        app->render_calibration = render_driver_calibrate(app, objects);
+        app->render_calibration["machine"] = machine;
+        app->is_virgin = false;  // Store the result
+    }
 
-    // If no screen objects defined in settings file, create two default objects
-    if (app->screen_objects.size() <= 1)
-    {
-        float x_pos = (float) app->work_area.x + (float) (app->work_area.w * 5.0 / 6.0);
-        float y_pos = (float) app->work_area.y + (float) (app->work_area.h * 1.0 / 5.0);
-
-        // create image object
-        auto image = new Image(
-                x_pos, y_pos,
-                app->logo_file_name,
-                app->base_path,
-                app->logo_scale,
-                0.0,
-                false,
-                1.f,
-                app->renderer);
-        app->screen_objects.push_back(image);
-
-        // create signature object
-        y_pos += (float) ((float) image->extent.h * image->scale * 0.6);
-        auto text = new Signature(
-                app->text_content,
-                x_pos, y_pos,
-                app->text_font_name,
-                (float) app->text_font_size,
-                app->text_font_color,
-                app->base_path,
-                app->text_scale,
-                app->text_rotate,
-                1.f,
-                app->renderer);
-        app->screen_objects.push_back(text);
+    const auto &driver = app->render_calibration["driver"];
+    if (!driver.is_string() || driver.get<string>().empty())
+    {
+        return nullptr;
+    }
+    return driver.get_ref<const string &>().c_str();
+}
 
-        app->is_virgin = false;
 
-        if (!text->valid() || !image->valid())
+// Benchmarks a representative frame of the scene (the default objects if the settings define none)
+// on every available renderer backend. The window is still hidden, so frames are drawn into a target
+// texture of the backbuffer's size, and a pixel is read back after each one to wait for the GPU.
+// The dash pattern changes with every frame and is rasterized in place, so the line layer raster and
+// upload are included.
+// Returns {"driver": fastest, "frame_us": {driver: microseconds per frame, ...}}.
+json render_driver_calibrate(AppContext *app, json &objects)
+{
+    OverlayWindow &overlay = app->overlays[0];
+    const int warmup_frames = 2;
+    const int frames = 20;
+    const SDL_Rect probe = {0, 0, 1, 1};
+    json result = {{"driver", ""}, {"frame_us", json::object()}};
+    double best_us = 0.0;
+    int width, height, bbwidth, bbheight;
+
+    SDL_GetWindowSize(overlay.window, &width, &height);
+    SDL_GetWindowSizeInPixels(overlay.window, &bbwidth, &bbheight);
+    overlay.pixel_scale = (width > 0 && bbwidth > 0) ? (float)bbwidth / (float)width : 1.f;
+
+    for (int i = 0; i < SDL_GetNumRenderDrivers(); i++)
+    {
+        const char *driver = SDL_GetRenderDriver(i);
+        SDL_Texture *target = nullptr;
+        Uint64 start = 0;
+
+        overlay.renderer = SDL_CreateRenderer(overlay.window, driver);
+        if (!overlay.renderer)
         {
-            return app_init_failed();
+            SDL_Log("Calibration: renderer \"%s\" not available: %s", driver, SDL_GetError());
+            continue;
         }
-    }
+        app->renderer = overlay.renderer;
+        asset_cache.select_pixel_format(overlay.renderer);
+
+        // Build the scene for this renderer
+        app->scene = new SceneStore;
+        screen_objects_add_lines(app);
+        init_screen_objects(app, objects);
+        if (app->scene->size() <= 1)
+        {
+            screen_objects_add_defaults(app);
+        }
+        app->scene->line_object()->raster_thread = false;
 
-    // print some information about the window
-    {
-        int width, height, bbwidth, bbheight;
-        SDL_GetWindowSize(app->window, &width, &height);
-        SDL_GetWindowSizeInPixels(app->window, &bbwidth, &bbheight);
-        SDL_Log("Window size: %ix%i", width, height);
-        SDL_Log("Backbuffer size: %ix%i", bbwidth, bbheight);
-        if (width != bbwidth)
+        target = SDL_CreateTexture(overlay.renderer, asset_cache.pixel_format, SDL_TEXTUREACCESS_TARGET, bbwidth, bbheight);
+        if (!target || !SDL_SetRenderTarget(overlay.renderer, target))
         {
-            SDL_Log("This is a highdpi environment.");
+            SDL_Log("Calibration: renderer \"%s\" has no render targets: %s", driver, SDL_GetError());
+            SDL_DestroyTexture(target);
+            free_screen_objects(app);
+            SDL_DestroyRenderer(overlay.renderer);
+            overlay.renderer = nullptr;
+            app->renderer = nullptr;
+            continue;
+        }
+        // (The render scale belongs to the target)
+        SDL_SetRenderScale(overlay.renderer, overlay.pixel_scale, overlay.pixel_scale);
+        SDL_SetRenderDrawBlendMode(overlay.renderer, SDL_BLENDMODE_BLEND);
+
+        SceneSnapshot snapshot;
+        for (int frame = 0; frame < warmup_frames + frames; frame++)
+        {
+            if (frame == warmup_frames)
+            {
+                start = SDL_GetPerformanceCounter();
+            }
+            app->idle_ticks++;
+            snapshot.capture(app);
+            SDL_SetRenderDrawColor(overlay.renderer, 0, 0, 0, 0);
+            SDL_RenderClear(overlay.renderer);
+            draw_scene(snapshot, overlay, app->batch, 0);
+            app->batch.flush(overlay.renderer);
+            SDL_DestroySurface(SDL_RenderReadPixels(overlay.renderer, &probe));
+        }
+
+        double frame_us = (double)(SDL_GetPerformanceCounter() - start) * 1e6
+                          / (double)SDL_GetPerformanceFrequency() / frames;
+        result["frame_us"][driver] = round_to_precision(frame_us, 1);
+        SDL_Log("Calibration: \"%s\" %.1f us/frame", driver, frame_us);
+
+        if (result["driver"] == "" || frame_us < best_us)
+        {
+            result["driver"] = driver;
+            best_us = frame_us;
         }
+
+        SDL_SetRenderTarget(overlay.renderer, nullptr);
+        SDL_DestroyTexture(target);
+        free_screen_objects(app);
+        asset_cache.collect();
+        SDL_DestroyRenderer(overlay.renderer);
+        overlay.renderer = nullptr;
+        app->renderer = nullptr;
     }
 
-    SDL_Log("Application started successfully!");
+    app->idle_ticks = 0;
+    app->startup.objects.clear();  // (Scenes built for calibration aren't part of the startup report)
+    return result;
+}
 
-    // Prepare background
-    SDL_SetRenderVSync(app->renderer, SDL_RENDERER_VSYNC_ADAPTIVE);   // enable vsync
-    SDL_SetRenderDrawBlendMode(app->renderer, SDL_BLENDMODE_BLEND);
-    SDL_SetRenderDrawColor(app->renderer, 0, 0, 0, 255); // Set black background
-    SDL_RenderClear(app->renderer);
-    SDL_RenderPresent(app->renderer); // Present first frame
 
-    // draw
-    draw(app);
-    SDL_ShowWindow(app->window);
+// Benchmark mode: runs the suite and records the baseline or compares against it.
+// Returns false on a regression (the process exits nonzero).
+bool benchmark_main(AppContext *app)
+{
+    bool passed = true;
 
-    return SDL_APP_CONTINUE;
+    // (The window stays hidden, frames are drawn into a target texture, see benchmark_run())
+    SDL_Log("Benchmark on \"%s\"", SDL_GetRendererName(app->renderer));
+    json results = benchmark_run(app);
+
+    if (app->benchmark_record)
+    {
+        // Recording over an existing file (e.g. the thresholds in benchmarks/baseline.json) keeps its notes
+        // and thresholds, only the times and the renderer are replaced
+        json baseline = json::object();
+        {
+            std::ifstream existing(app->benchmark_file);
+            if (existing.is_open())
+            {
+                baseline = json::parse(existing, nullptr, false);
+                if (!baseline.is_object()) baseline = json::object();
+            }
+        }
+        baseline["renderer"] = results["renderer"];
+        json &benchmarks = baseline["benchmarks"];
+        if (!benchmarks.is_object()) benchmarks = json::object();
+        for (const auto &[name, result] : results["benchmarks"].items())
+        {
+            json &entry = benchmarks[name];
+            if (!entry.is_object()) entry = json::object();
+            entry["us"] = result["us"];
+            if (!entry.contains("threshold_pct")) entry["threshold_pct"] = result["threshold_pct"];
+        }
+
+        std::ofstream file(app->benchmark_file);
+        if (!file.is_open())
+        {
+            SDL_Log("Failed to write benchmark baseline \"%s\"", app->benchmark_file.c_str());
+            return false;
+        }
+        file << baseline.dump(4);
+        SDL_Log("Benchmark baseline written to \"%s\"", app->benchmark_file.c_str());
+    }
+    else
+    {
+        std::ifstream file(app->benchmark_file);
+        json baseline;
+        try
+        {
+            file >> baseline;
+        }
+        catch (const std::exception &e)
+        {
+            SDL_Log("Failed to read benchmark baseline \"%s\": %s", app->benchmark_file.c_str(), e.what());
+            return false;
+        }
+        passed = benchmark_compare(baseline, results);
+    }
+    return passed;
 }
 
 
-void SDL_AppQuit(void* appstate, [[maybe_unused]] SDL_AppResult result)
+// Median time of `f()` over `iterations` runs (after `warmup` runs), in microseconds
+template <typename F>
+double benchmark_us(int warmup, int iterations, F &&f)
 {
-    auto* app = (AppContext*)appstate;
+    vector<double> times;
 
-    if (result == SDL_APP_SUCCESS)
+    for (int i = 0; i < warmup; i++)
     {
-        settings_write(app);
+        f();
     }
-
-    if (app)
+    for (int i = 0; i < iterations; i++)
     {
-        SDL_HideWindow(app->window);
-
-        SDL_DestroyRenderer(app->renderer);
-        SDL_DestroyWindow(app->window);
-        SDL_DestroyCursor(app->handCursor);
-        free_screen_objects(app);
-
-        delete app;
+        Uint64 start = SDL_GetPerformanceCounter();
+        f();
+        times.push_back((double)(SDL_GetPerformanceCounter() - start) * 1e6 / (double)SDL_GetPerformanceFrequency());
     }
-
-    TTF_Quit();
-
-    SDL_Log("Application quit successfully!");
-    SDL_Quit();
+    std::nth_element(times.begin(), times.begin() + iterations / 2, times.end());
+    return times[iterations / 2];
 }
 
 
-SDL_AppResult SDL_AppIterate(void *appstate)
+// Runs the microbenchmarks and the headless scene suite on the current scene (the window is hidden).
+// Returns {"renderer": name, "benchmarks": {name: {"us": median, "threshold_pct": allowed slowdown}, ...}}.
+json benchmark_run(AppContext *app)
 {
-    auto* app = (AppContext*)appstate;
-    int timeout = -1;
-    Uint64 ticks = SDL_GetTicks();
-
-    if (app->app_quit != SDL_APP_CONTINUE) return app->app_quit;
-
-    if (app->needs_redraw)
+    OverlayWindow &overlay = app->overlays[0];
+    SceneStore *scene = app->scene;
+    LineObject *lines = scene->line_object();
+    json benchmarks = json::object();
+    auto record = [&](const char *name, double us, double threshold_pct)
     {
-        draw(app);
-    }
+        benchmarks[name] = {{"us", round_to_precision(us, 1)}, {"threshold_pct", threshold_pct}};
+        SDL_Log("  %-20s %10.1f us", name, us);
+    };
 
-    auto *line_object = dynamic_cast<LineObject *>(app->screen_objects[0]);
-    if (line_object && line_object->dashed && line_object->dashed_gap > 0 && line_object->width > 0 && !app->hidden)
+    // Line layer raster (`LineObject::draw()` with a new dash pattern each time, in place)
+    if (lines)
     {
-        Sint64 delay = (Sint64)(ticks - app->idle_ticks);
-
-        if (delay >= app->idle_delay_ms)
+        record("lines_raster", benchmark_us(2, 20, [&]
         {
-            timeout = 0;
-            app->idle_ticks = ticks;
-            app->needs_redraw = true;
-        }
-        else
-        {
-            timeout = SDL_max(0, app->idle_delay_ms - (int)delay);
-        }
+            app->idle_ticks++;
+            LineObject::Style style = lines->style();
+            style.raster_thread = false;
+            lines->draw(style, app->alpha, overlay, app->batch);
+            app->batch.flush(overlay.renderer);
+        }), 15.0);
     }
 
-
-    if (app->have_animations && !app->hidden)
+    // GIF decoding of all frames onto a canvas, the in-tree decoder against giflib (DGifSlurp).
+    // The GIF goes to the temp directory, the install directory may be read-only.
+    std::error_code error;
+    path gif_file = std::filesystem::temp_directory_path(error) / "dragon.benchmark.gif";
+    bool have_gif = !error && benchmark_gif_write(gif_file);
+    const MappedFile *gif_source = have_gif ? asset_cache.map_file(gif_file.string()) : nullptr;
+    if (gif_source)
     {
-        for (auto &obj: app->screen_objects)
+        SDL_Surface *canvas = SDL_CreateSurface(256, 256, asset_cache.pixel_format);
+        const SDL_PixelFormatDetails *format_details = SDL_GetPixelFormatDetails(asset_cache.pixel_format);
+        Uint32 palette[256];
+        auto map_palette = [&](const GifColorType *colors, int color_count, int transparent_color)
+        {
+            for (int i = 0; i < 256; i++)
+            {
+                palette[i] = (i < color_count && i != transparent_color)
+                    ? SDL_MapRGBA(format_details, nullptr, colors[i].Red, colors[i].Green, colors[i].Blue, 255)
+                    : 0;
+            }
+        };
+        auto decoder = std::make_unique<GifDecoder>();
+
+        record("gif_decode", benchmark_us(2, 20, [&]
         {
-            auto* gif = dynamic_cast<AnimatedGif *>(obj);
+            if (!canvas || !decoder->open(gif_source)) return;
+            for (int i = 0; i < (int)decoder->frames.size(); i++)
+            {
+                const GifDecoder::Frame &frame = decoder->frames[i];
+                map_palette(frame.colors, frame.color_count, frame.transparent_color_index);
+                decoder->decode(i, palette, canvas);
+            }
+        }), 15.0);
 
-            if (gif && gif->valid())
+        record("gif_decode_giflib", benchmark_us(2, 20, [&]
+        {
+            std::pair<const MappedFile *, size_t> reader = {gif_source, 0};
+            GifFileType *gif = DGifOpen(&reader, [](GifFileType *gif, GifByteType *buffer, int length) -> int
             {
-                Uint64 delay = (Sint64)(ticks - gif->latest_ticks);
-                if (delay >= gif->frame_info[gif->current_frame].delay_ms)
-                {
-                    gif->current_frame = (gif->current_frame + 1) % gif->frame_count;
-                    gif->render_frame(app->renderer);
-                    gif->latest_ticks = ticks;
-                    app->needs_redraw = true;
-                }
-                else
+                auto *input = (std::pair<const MappedFile *, size_t> *)gif->UserData;
+                size_t n = SDL_min((size_t)length, input->first->size - input->second);
+                memcpy(buffer, input->first->data + input->second, n);
+                input->second += n;
+                return (int)n;
+            }, nullptr);
+            if (!gif) return;
+
+            if (canvas && DGifSlurp(gif) == GIF_OK && gif->SColorMap)
+            {
+                for (int i = 0; i < gif->ImageCount; i++)
                 {
-                    timeout = SDL_min(
-                                (timeout < 0) ? app->idle_delay_ms : timeout,
-                                SDL_max(
-                                        0, gif->frame_info[gif->current_frame].delay_ms - (int)delay));
-                    // SDL_Log("next frame in %i ms", (int) (timeout));
+                    const SavedImage &frame = gif->SavedImages[i];
+                    const GifImageDesc &desc = frame.ImageDesc;
+                    const ColorMapObject *color_map = desc.ColorMap ? desc.ColorMap : gif->SColorMap;
+                    const Uint8 *bits = frame.RasterBits;
+                    GraphicsControlBlock gcb = {};
+                    gcb.TransparentColor = NO_TRANSPARENT_COLOR;
+                    DGifSavedExtensionToGCB(gif, i, &gcb);
+                    map_palette(color_map->Colors, color_map->ColorCount, gcb.TransparentColor);
+
+                    for (int y = 0; y < desc.Height && desc.Top + y < canvas->h; y++)
+                    {
+                        auto *row = (Uint32*)(void*)((Uint8*)canvas->pixels + (desc.Top + y) * canvas->pitch) + desc.Left;
+                        for (int x = 0; x < desc.Width && desc.Left + x < canvas->w; x++)
+                        {
+                            Uint32 color = palette[bits[y * desc.Width + x]];
+                            if (color) row[x] = color;
+                        }
+                    }
                 }
             }
-        }
+            DGifCloseFile(gif, nullptr);
+        }), 15.0);
+
+        SDL_DestroySurface(canvas);
+        asset_cache.unmap_file(gif_source);
     }
 
-    if (!app->needs_redraw)
+    // GIF frames (`AnimatedGif::frame_texture()` decoding and uploading every frame)
+    if (have_gif &&
+        screen_objects_add_image(
+                (float)app->work_area.w / 2.f, (float)app->work_area.h / 2.f,
+                gif_file.string().c_str(), app))
     {
-        // Wait for next event with timeout (timeout==-1 means "no timeout")
-        SDL_WaitEventTimeout(nullptr, timeout);
-        // SDL_Log("timeout: %i", timeout);
+        AnimatedGif &gif = scene->gifs.back();
+        gif.cache_frames = false;
+        record("gif_render_frame", benchmark_us(4, 64, [&]
+        {
+            gif.current_frame = (gif.current_frame + 1) % gif.frame_count;
+            gif.frame_texture(gif.current_frame, app->renderer);
+            asset_cache.collect();
+        }), 15.0);
     }
 
-    return app->app_quit;
+    // Event dispatch to the objects (mouse motion across the scene in layout mode).
+    // The objects are called directly: SDL_AppEvent() would also drain the real event queue to coalesce bursts.
+    {
+        bool layout_mode = app->layout_mode;
+        int step = 0;
+        app->layout_mode = true;
+        record("event_dispatch", benchmark_us(16, 256, [&]
+        {
+            SDL_Event event = {};
+            event.type = SDL_EVENT_MOUSE_MOTION;
+            event.motion.windowID = overlay.window_id;
+            event.motion.x = (float)((step * 37) % SDL_max(1, overlay.area.w));
+            event.motion.y = (float)((step * 23) % SDL_max(1, overlay.area.h));
+            step++;
+            overlay_event_to_scene(app, &event);
+            screen_objects_handle_event(&event, app);
+        }), 25.0);
+        app->layout_mode = layout_mode;
+        app->mouse_capture = {};
+    }
+
+    // Whole frames of the scene (new dash pattern each time). As in the calibration, the frame goes to a target
+    // texture of the backbuffer's size and a pixel is read back instead of the present, which waits for the GPU
+    // without showing a window.
+    int bbwidth, bbheight;
+    const SDL_Rect probe = {0, 0, 1, 1};
+    SDL_GetWindowSizeInPixels(overlay.window, &bbwidth, &bbheight);
+    SDL_Texture *target = SDL_CreateTexture(overlay.renderer, asset_cache.pixel_format, SDL_TEXTUREACCESS_TARGET, bbwidth, bbheight);
+    if (target && SDL_SetRenderTarget(overlay.renderer, target))
+    {
+        // (The render scale belongs to the target)
+        SDL_SetRenderScale(overlay.renderer, overlay.pixel_scale, overlay.pixel_scale);
+        SceneSnapshot snapshot;
+        record("frame", benchmark_us(2, 20, [&]
+        {
+            app->idle_ticks++;
+            snapshot.capture(app);
+            snapshot.lines.raster_thread = false;
+            SDL_SetRenderDrawColor(overlay.renderer, 0, 0, 0, 0);
+            SDL_RenderClear(overlay.renderer);
+            draw_scene(snapshot, overlay, app->batch, 0);
+            app->batch.flush(overlay.renderer);
+            SDL_DestroySurface(SDL_RenderReadPixels(overlay.renderer, &probe));
+        }), 15.0);
+        SDL_SetRenderTarget(overlay.renderer, nullptr);
+    }
+    else
+    {
+        SDL_Log("Benchmark: no render targets, \"frame\" skipped: %s", SDL_GetError());
+    }
+    SDL_DestroyTexture(target);
+
+    free_screen_objects(app);
+    SDL_RemovePath(gif_file.string().c_str());
+
+    return {{"renderer", SDL_GetRendererName(app->renderer)}, {"benchmarks", benchmarks}};
 }
 
 
-SDL_AppResult SDL_AppEvent(void *appstate, SDL_Event* event)
+// Logs a table of baseline against current results, false if any benchmark got slower than its threshold
+// or has no recorded time in the baseline (a thresholds-only baseline can't pass).
+// Benchmarks missing on either side are listed, but don't fail.
+bool benchmark_compare(const json &baseline, const json &results)
 {
-    auto* app = (AppContext*)appstate;
+    bool passed = true;
+    const json &base = baseline.value("benchmarks", json::object());
+    const json &current = results["benchmarks"];
 
-    // Check if the current event is a mouse motion event
-    if (event->type == SDL_EVENT_MOUSE_MOTION)
+    if (baseline.value("renderer", "") != results["renderer"])
     {
-        SDL_Event e;
-
-        // Drain the event queue of all pending mouse motion events,
-        // but only keep the most recent one (the last in the queue)
-        while (SDL_PeepEvents(
-                &e,                  // Pointer to a temporary event structure
-                1,                   // Number of events to process at a time
-                SDL_GETEVENT,        // Action: get events from the queue
-                SDL_EVENT_MOUSE_MOTION, // Minimum event type to retrieve
-                SDL_EVENT_MOUSE_MOTION  // Maximum event type to retrieve (only motion)
-        ))
-        {
-            // Overwrite the original event with the latest mouse motion event
-            *event = e;
-        }
+        SDL_Log("Note: baseline was taken on \"%s\"", baseline.value("renderer", "").c_str());
     }
 
-    ScreenObject* line_object = nullptr;
-    bool event_handled = false;
-
-    // Find the LineObject
-    for (auto& obj : app->screen_objects)
+    SDL_Log("%-20s %12s %12s %9s %9s", "benchmark", "baseline", "current", "change", "allowed");
+    for (const auto &[name, result] : current.items())
     {
-        if (strcmp(obj->type_name(), "Lines") == 0)
+        if (!base.contains(name))
         {
-            line_object = obj;
-            break;
+            SDL_Log("%-20s %12s %9.1f us %9s %9s  new", name.c_str(), "-", result["us"].get<double>(), "", "");
+            continue;
         }
-    }
-
-    // Handle events for all objects except LineObject
-    for (auto it = app->screen_objects.begin(); it != app->screen_objects.end(); ++it)
-    {
-        if (*it == line_object) continue;
 
-        int needs_update = 0;
-        if ((*it)->handle_event(event, needs_update, app))
-        
+        double base_us = base[name].value("us", 0.0);
+        double us = result["us"].get<double>();
+        if (base_us <= 0.0)
         {
-            if (needs_update >= UPDATE_VIEW_CHANGED)
-            {
-                app->needs_redraw = true;
-            }
-            if (needs_update >= UPDATE_SETTINGS_CHANGED)
-            {
-                app->is_virgin = false;
-            }
-            event->type = SDL_EVENT_LAST;
-            event_handled = true;
-            break;
+            SDL_Log("%-20s %12s %9.1f us %9s %9s  NOT RECORDED", name.c_str(), "-", us, "", "");
+            passed = false;
+            continue;
         }
-    }
+        double threshold = base[name].value("threshold_pct", result["threshold_pct"].get<double>());
+        double change = (us / base_us - 1.0) * 100.0;
+        bool regressed = change > threshold;
 
-    // If no other object handled the event, handle it for the LineObject
-    if (!event_handled && line_object)
+        SDL_Log("%-20s %9.1f us %9.1f us %+8.1f%% %8.1f%%  %s",
+                name.c_str(), base_us, us, change, threshold, regressed ? "REGRESSION" : "ok");
+        if (regressed) passed = false;
+    }
+    for (const auto &[name, result] : base.items())
     {
-        int needs_update = 0;
-        if (line_object->handle_event(event, needs_update, app))
+        if (!current.contains(name))
         {
-            if (needs_update >= UPDATE_VIEW_CHANGED)
-            {
-                app->needs_redraw = true;
-            }
-            if (needs_update >= UPDATE_SETTINGS_CHANGED)
-            {
-                app->is_virgin = false;
-            }
-            event->type = SDL_EVENT_LAST;
+            SDL_Log("%-20s %9.1f us %12s %9s %9s  missing", name.c_str(), result.value("us", 0.0), "-", "", "");
         }
     }
 
-    if (event->type == SDL_EVENT_QUIT)
-    {
-        app->app_quit = SDL_APP_SUCCESS;
-    }
+    SDL_Log("%s", passed ? "Benchmarks passed." : "Benchmarks regressed (or the baseline has no times, record them first).");
+    return passed;
+}
 
-    else if (event->type == SDL_EVENT_WINDOW_MINIMIZED)
-    {
-        SDL_RestoreWindow(app->window);
-        app->needs_redraw = true;
-    }
 
-    else if (event->type == SDL_EVENT_WINDOW_RESTORED)
-    {
-        app->needs_redraw = true;
-    }
+// Writes a synthetic 256x256 animated GIF (16 full frames, 40 ms each) for the GIF benchmark
+bool benchmark_gif_write(const path &file)
+{
+    const int size = 256;
+    const int frames = 16;
+    int error = 0;
+    bool written = true;
 
-    else if (event->type == SDL_EVENT_WINDOW_FOCUS_GAINED)
+    GifFileType *gif = EGifOpenFileName(file.string().c_str(), false, &error);
+    if (!gif)
     {
-        app->needs_redraw = true;
+        SDL_Log("Failed to write benchmark GIF: %s", GifErrorString(error));
+        return false;
     }
 
-    else if (event->type == SDL_EVENT_WINDOW_FOCUS_LOST)
+    ColorMapObject *colors = GifMakeMapObject(256, nullptr);
+    for (int i = 0; colors && i < 256; i++)
     {
-        app->mouse_capture = nullptr;
+        colors->Colors[i] = {(GifByteType)i, (GifByteType)(255 - i), (GifByteType)(i * 7)};
     }
+    EGifSetGifVersion(gif, true);
+    written = colors && EGifPutScreenDesc(gif, size, size, 8, 0, colors) == GIF_OK;
 
-    else if (event->type == SDL_EVENT_MOUSE_WHEEL)
+    vector<GifByteType> row(size);
+    for (int frame = 0; written && frame < frames; frame++)
     {
-        if (app->layout_mode)
+        GraphicsControlBlock gcb = {DISPOSAL_UNSPECIFIED, false, 4, NO_TRANSPARENT_COLOR};
+        GifByteType extension[4];
+        EGifGCBToExtension(&gcb, extension);
+        written = EGifPutExtension(gif, GRAPHICS_EXT_FUNC_CODE, 4, extension) == GIF_OK &&
+                  EGifPutImageDesc(gif, 0, 0, size, size, false, nullptr) == GIF_OK;
+
+        for (int y = 0; written && y < size; y++)
         {
-            if (event->wheel.y < 0)
-            {
-                app->alpha = SDL_max(0, app->alpha - 5.f / 255.f);
-                app->is_virgin = false;
-            }
-            else
+            for (int x = 0; x < size; x++)
             {
-                app->alpha = SDL_min(1.f, app->alpha + 5.f / 255.f);
-                app->is_virgin = false;
+                // Blocks with some structure, so the LZW tables fill up like with real content
+                row[x] = (GifByteType)(((x / 8) ^ (y / 8)) * 5 + frame * 3 + (x * y) / 512);
             }
-            app->needs_redraw = true;
+            written = EGifPutLine(gif, row.data(), size) == GIF_OK;
         }
     }
 
-    else if (event->type == SDL_EVENT_MOUSE_MOTION)
+    if (EGifCloseFile(gif, &error) != GIF_OK) written = false;
+    GifFreeMapObject(colors);
+    return written;
+}
+
+
+// Startup report: logs the time per startup phase, then builds the scene a second time with warm
+// file caches (the first build is as cold as the caches were at launch) and compares per object
+// (matched by id, the rebuild keeps the ids).
+// The report is also written to "dragon.startup.json" in the program directory.
+void startup_report(AppContext *app)
+{
+    StartupProfile &profile = app->startup;
+    std::unordered_map<Uint32, double> cold_ms_by_id;
+    for (const auto &object : profile.objects)
     {
-        if (app->layout_mode)
-        {
-            SDL_SetCursor(SDL_GetDefaultCursor());
-        }
+        cold_ms_by_id[object.id] = object.ms;
     }
+    double cold_total = profile.total_ms();
+    json objects = json::array();
 
-    else if (event->type == SDL_EVENT_KEY_DOWN)
+    SDL_Log("Startup phases:");
+    for (const auto &phase : profile.phases)
     {
-        app->needs_redraw = true;
+        SDL_Log("  %-28s %9.2f ms", phase.name.c_str(), phase.ms);
+    }
+    SDL_Log("  %-28s %9.2f ms", "total (to first frame)", cold_total);
 
-        if (event->key.key == SDLK_LEFT)
-        {
-            app->alpha = SDL_max(0, app->alpha - 17.f / 255.f);
-            app->is_virgin = false;
-        }
-        else if (event->key.key == SDLK_RIGHT)
-        {
-            app->alpha = SDL_min(1.f, app->alpha + 17.f / 255.f);
-            app->is_virgin = false;
-        }
-        else if (event->key.key == SDLK_X)
-        {
-            app->app_quit = SDL_APP_SUCCESS;
-        }
-        else if ((event->key.key == SDLK_SPACE) or (event->key.key == SDLK_RETURN))
-        {
-            app->layout_mode = !app->layout_mode;
-            update_layout_mode(app);
-        }
-        else if (event->key.key == SDLK_H)
-        {
-            app->hidden = !app->hidden;
-            app->is_virgin = false;
-        }
-        else if (event->key.key == SDLK_V && SDL_GetModState() & SDL_KMOD_CTRL)
-        {
-            clipboard_insert(app);
-        }
-        else
-        {
-            app->needs_redraw = false;
-        }
+    // Rebuild the scene from its own description in this process, decoded files and uploads are dropped,
+    // the OS file cache (and the process: loaded modules, driver state) is warm now
+    for (Uint32 slot = 0; slot < app->scene->size(); slot++)
+    {
+        if (app->scene->valid(slot)) objects.push_back(app->scene->to_json(slot));
     }
+    free_screen_objects(app);
+    asset_cache.clear();
+    profile.objects.clear();
 
-    else if (event->type == SDL_EVENT_DROP_TEXT)
+    Uint64 start = SDL_GetPerformanceCounter();
+    app->scene = new SceneStore;
+    screen_objects_add_lines(app);
+    init_screen_objects(app, objects);
+    double warm_objects_ms = StartupProfile::ms(start, SDL_GetPerformanceCounter());
+    draw(app);
+    double warm_draw_ms = StartupProfile::ms(start, SDL_GetPerformanceCounter()) - warm_objects_ms;
+
+    SDL_Log("Scene objects:                   cold ms    warm ms (in-process rebuild)");
+    json object_report = json::array();
+    for (const auto &warm : profile.objects)
     {
-        if (event->drop.data)
+        auto cold = cold_ms_by_id.find(warm.id);
+        if (cold == cold_ms_by_id.end())
         {
-            screen_objects_add_text(
-                    event->drop.x,
-                    event->drop.y,
-                    event->drop.data,
-                    app);
+            continue;
         }
+        SDL_Log("  %-28s %9.2f  %9.2f", warm.name.c_str(), cold->second, warm.ms);
+        object_report.push_back({
+            {"id", warm.id},
+            {"name", warm.name},
+            {"cold_ms", round_to_precision(cold->second, 2)},
+            {"warm_ms", round_to_precision(warm.ms, 2)}
+        });
     }
+    SDL_Log("  %-28s %9s  %9.2f", "scene objects (rebuild)", "", warm_objects_ms);
+    SDL_Log("  %-28s %9s  %9.2f", "first draw (rebuild)", "", warm_draw_ms);
+
+    json report = {
+        {"renderer", SDL_GetRendererName(app->renderer)},
+        {"phases", StartupProfile::to_json(profile.phases)},
+        {"total_ms", round_to_precision(cold_total, 2)},
+        {"objects", object_report},
+        {"warm", {
+            {"kind", "in-process rebuild"},
+            {"scene_objects_ms", round_to_precision(warm_objects_ms, 2)},
+            {"first_draw_ms", round_to_precision(warm_draw_ms, 2)}
+        }}
+    };
 
-    else if (event->type == SDL_EVENT_DROP_FILE)
+    std::ofstream file(app->base_path / "dragon.startup.json");
+    if (file.is_open())
     {
-        if (event->drop.data)
-        {
-            screen_objects_add_image(
-                    event->drop.x,
-                    event->drop.y,
-                    event->drop.data,
-                    app);
-        }
+        file << report.dump(4);
+        SDL_Log("Startup report written.");
     }
+}
 
-    return SDL_APP_CONTINUE;
+
+void overlay_window_destroy(OverlayWindow &overlay)
+{
+    if (overlay.drag_background) SDL_DestroyTexture(overlay.drag_background);
+    overlay.drag_background = nullptr;
+    SDL_DestroyRenderer(overlay.renderer);
+    overlay.renderer = nullptr;
+    SDL_DestroyWindow(overlay.window);
+    overlay.window = nullptr;
+    overlay.hwnd = nullptr;
 }
 
 
-void update_screen_metrics(AppContext* app)
+// Opens an overlay window on every display not covered by the primary window
+void overlays_add_displays(AppContext *app)
 {
-    SDL_FPoint mouse;
-    SDL_GetMouseState(&mouse.x, &mouse.y);
-    SDL_Point pt((int)mouse.x, (int)mouse.y);
-    int displayIndex = SDL_GetDisplayForPoint(&pt);
+    int count = 0;
+    SDL_DisplayID *displays = SDL_GetDisplays(&count);
 
-    SDL_GetDisplayUsableBounds(displayIndex, &app->screen_rect);
+    if (!displays) return;
 
-    if (app->screen_rect_init.x >= 0)
-    {
-        app->screen_rect.x = app->screen_rect_init.x;
-    }
-    if (app->screen_rect_init.y >= 0)
+    for (int i = 0; i < count; i++)
     {
-        app->screen_rect.y = app->screen_rect_init.y;
+        SDL_Rect bounds;
+
+        if (!SDL_GetDisplayUsableBounds(displays[i], &bounds)) continue;
+        if (SDL_HasRectIntersection(&bounds, &app->work_area)) continue;
+
+        app->overlays.emplace_back();
+        if (!overlay_window_create(app, app->overlays.back(), bounds) ||
+            !overlay_renderer_create(app, app->overlays.back(), SDL_GetRendererName(app->renderer)))
+        {
+            SDL_Log("Failed to open overlay on display %u: %s", (unsigned)displays[i], SDL_GetError());
+            overlay_window_destroy(app->overlays.back());
+            app->overlays.pop_back();
+        }
     }
-    if (app->screen_rect_init.w >= 0)
+
+    SDL_free(displays);
+}
+
+
+// Merges the queued events continuing a burst into `event`, returns the number of events it stands for.
+// Mouse motions keep the most recent one. Wheel events at the same position add up their deltas,
+// and their steps (`wheel_steps()` of each event) add up in `wheel_net_steps`.
+// Key repeats of the same key are counted (the count matters for steps and toggles, setting keys apply once).
+int event_coalesce_burst(SDL_Event *event, int &wheel_net_steps)
+{
+    int count = 1;
+    SDL_Event e;
+
+    if (event->type == SDL_EVENT_MOUSE_MOTION)
     {
-        app->screen_rect.w = app->screen_rect_init.w;
+        // Drain the event queue of all pending mouse motion events,
+        // but only keep the most recent one (the last in the queue)
+        while (SDL_PeepEvents(
+                &e,                  // Pointer to a temporary event structure
+                1,                   // Number of events to process at a time
+                SDL_GETEVENT,        // Action: get events from the queue
+                SDL_EVENT_MOUSE_MOTION, // Minimum event type to retrieve
+                SDL_EVENT_MOUSE_MOTION  // Maximum event type to retrieve (only motion)
+        ))
+        {
+            // Overwrite the original event with the latest mouse motion event
+            *event = e;
+            count++;
+        }
     }
-    if (app->screen_rect_init.h >= 0)
+
+    else if (event->type == SDL_EVENT_MOUSE_WHEEL)
     {
-        app->screen_rect.h = app->screen_rect_init.h;
+        // Only directly following events (same window and position, so the same target object).
+        // Steps are counted per event, as if the events were handled one by one.
+        wheel_net_steps = wheel_steps(event->wheel);
+        while (SDL_PeepEvents(&e, 1, SDL_PEEKEVENT, SDL_EVENT_FIRST, SDL_EVENT_LAST) == 1 &&
+               e.type == SDL_EVENT_MOUSE_WHEEL &&
+               e.wheel.windowID == event->wheel.windowID &&
+               e.wheel.direction == event->wheel.direction &&
+               e.wheel.mouse_x == event->wheel.mouse_x &&
+               e.wheel.mouse_y == event->wheel.mouse_y)
+        {
+            SDL_PeepEvents(&e, 1, SDL_GETEVENT, SDL_EVENT_MOUSE_WHEEL, SDL_EVENT_MOUSE_WHEEL);
+            event->wheel.x += e.wheel.x;
+            event->wheel.y += e.wheel.y;
+            wheel_net_steps += wheel_steps(e.wheel);
+            count++;
+        }
     }
-    app->work_area = app->screen_rect;
 
-    // Not needed, since SDL_GetDisplayUsableBounds()
-    if (app->crop_bottom < 0)
+    else if (event->type == SDL_EVENT_KEY_DOWN && event->key.repeat)
     {
-        APPBARDATA abd = {0};
-        abd.cbSize = sizeof(APPBARDATA);
-        if (SHAppBarMessage(ABM_GETTASKBARPOS, &abd)) 
+        while (SDL_PeepEvents(&e, 1, SDL_PEEKEVENT, SDL_EVENT_FIRST, SDL_EVENT_LAST) == 1 &&
+               e.type == SDL_EVENT_KEY_DOWN &&
+               e.key.repeat &&
+               e.key.key == event->key.key &&
+               e.key.mod == event->key.mod &&
+               e.key.windowID == event->key.windowID)
         {
-            RECT rc = abd.rc;
-            int height = 0;
-
-            if (abd.uEdge == ABE_BOTTOM || abd.uEdge == ABE_TOP) 
-            {
-                height = rc.bottom - rc.top;
-            }
-            app->crop_bottom = height;
+            SDL_PeepEvents(&e, 1, SDL_GETEVENT, SDL_EVENT_KEY_DOWN, SDL_EVENT_KEY_DOWN);
+            count++;
         }
     }
-    app->work_area.h -= app->crop_bottom;
 
-    app->center_x = (float) app->work_area.x + (float) app->work_area.w / 2.f;
-    app->center_y = (float) app->work_area.y + (float) app->work_area.h / 2.f;
+    return count;
 }
 
 
-void update_layout_mode(AppContext* app)
+// Whole steps of a single wheel event, a fraction still counts as one step
+int wheel_steps(const SDL_MouseWheelEvent &wheel)
+{
+    if (wheel.y == 0.f) return 0;
+
+    int steps = (int)lroundf(wheel.y);
+    if (steps == 0) steps = (wheel.y < 0) ? -1 : 1;
+    return steps;
+}
+
+
+// Keys flipping a state, an even number of repeats leaves it as it was
+bool key_toggles(SDL_Keycode key)
+{
+    return key == SDLK_D || key == SDLK_F || key == SDLK_H || key == SDLK_SPACE || key == SDLK_RETURN;
+}
+
+
+// Translates window coordinates of mouse and drop events to scene coordinates
+void overlay_event_to_scene(AppContext *app, SDL_Event *event)
 {
-    if (app->layout_mode)
+    SDL_WindowID window_id;
+
+    switch (event->type)
     {
-        SetWindowLong(
-            app->hwnd,
-            GWL_EXSTYLE,
-            GetWindowLong(app->hwnd, GWL_EXSTYLE) & ~(WS_EX_LAYERED | WS_EX_TRANSPARENT)
-        );
+        case SDL_EVENT_MOUSE_MOTION: window_id = event->motion.windowID; break;
+        case SDL_EVENT_MOUSE_BUTTON_DOWN:
+        case SDL_EVENT_MOUSE_BUTTON_UP: window_id = event->button.windowID; break;
+        case SDL_EVENT_MOUSE_WHEEL: window_id = event->wheel.windowID; break;
+        case SDL_EVENT_DROP_TEXT:
+        case SDL_EVENT_DROP_FILE: window_id = event->drop.windowID; break;
+        default: return;
     }
-    else
+
+    for (const OverlayWindow &overlay : app->overlays)
     {
-        SetWindowLong(
-            app->hwnd,
-            GWL_EXSTYLE,
-            GetWindowLong(app->hwnd, GWL_EXSTYLE) | WS_EX_LAYERED | WS_EX_TRANSPARENT
-        );
+        if (overlay.window_id != window_id) continue;
+
+        auto dx = (float)overlay.area.x;
+        auto dy = (float)overlay.area.y;
+
+        switch (event->type)
+        {
+            case SDL_EVENT_MOUSE_MOTION:
+                event->motion.x += dx;
+                event->motion.y += dy;
+                break;
+            case SDL_EVENT_MOUSE_BUTTON_DOWN:
+            case SDL_EVENT_MOUSE_BUTTON_UP:
+                event->button.x += dx;
+                event->button.y += dy;
+                break;
+            case SDL_EVENT_MOUSE_WHEEL:
+                event->wheel.mouse_x += dx;
+                event->wheel.mouse_y += dy;
+                break;
+            default:
+                event->drop.x += dx;
+                event->drop.y += dy;
+                break;
+        }
+        return;
     }
 }
 
@@ -2240,7 +5979,10 @@ void init_screen_objects(AppContext* app, json &objects) {
         }
         if (object.contains("type"))
         {
-            ScreenObject* obj = nullptr;
+            SceneStore *scene = app->scene;
+            Uint32 id = object.value("id", 0u);
+            Uint32 slot = scene->size();
+            Uint64 object_start = SDL_GetPerformanceCounter();
 
             if (!object.contains("x") || object["x"] < 0)
             {
@@ -2252,48 +5994,57 @@ void init_screen_objects(AppContext* app, json &objects) {
             }
             if (object["type"] == "Signature")
             {
-                 obj = new Signature(
-                         object,
-                         app->base_path,
-                         app->renderer);
+                scene->emplace(
+                        scene->signatures, OBJECT_SIGNATURE, id,
+                        object,
+                        app->base_path);
             }
             else if (object["type"] == "Lines")
             {
-                // Find the existing LineObject and update its properties
-                for (auto& existing_obj : app->screen_objects) {
-                    if (strcmp(existing_obj->type_name(), "Lines") == 0) {
-                        auto lines = dynamic_cast<LineObject*>(existing_obj);
-                        if (lines) {
-                            lines->alpha = (float)object.value("alpha", 0.55f);
-                            lines->width = object.value("width", 1);
-                            lines->color = get_color_value(object, "color", 0x000000);
-                            lines->dashed = object.value("dashed", true);
-                            lines->dashed_len = object.value("dashed_len", 10);
-                            lines->dashed_gap = object.value("dashed_gap", 10);
-                            lines->line_angle = object.value("line_angle", 45.f);
-                            lines->line_spacing = object.value("line_spacing", 15.f);
-                        }
-                        break;
-                    }
+                // Update the existing LineObject's properties (don't add a new object)
+                auto lines = scene->line_object();
+                if (lines) {
+                    lines->alpha() = (float)object.value("alpha", 0.55f);
+                    lines->width = object.value("width", 1);
+                    lines->color = get_color_value(object, "color", 0x000000);
+                    lines->dashed = object.value("dashed", true);
+                    lines->dashed_len = object.value("dashed_len", 10);
+                    lines->dashed_gap = object.value("dashed_gap", 10);
+                    lines->line_angle = object.value("line_angle", 45.f);
+                    lines->line_spacing = object.value("line_spacing", 15.f);
+                    lines->raster_thread = object.value("raster_thread", true);
                 }
-                obj = nullptr; // Don't add a new object
             }
             else if (object["type"] == "Image")
             {
-                obj = new Image(
-                        object,
-                        app->renderer);
+                scene->emplace(
+                        scene->images, OBJECT_IMAGE, id,
+                        object);
             }
             else if (object["type"] == "AnimatedGif")
             {
-                obj = new AnimatedGif(
-                        object,
-                        app->renderer);
+                scene->emplace(
+                        scene->gifs, OBJECT_ANIMATED_GIF, id,
+                        object);
                 app->have_animations = true;
             }
+            else if (object["type"] == "TiledPattern")
+            {
+                scene->emplace(
+                        scene->patterns, OBJECT_TILED_PATTERN, id,
+                        object,
+                        app->base_path);
+            }
             // (Silently ignore unknown object types)
 
-            if (obj) app->screen_objects.push_back(obj);
+            // Only objects that were created and loaded are timed (the line object already exists)
+            if (scene->size() > slot && scene->valid(slot))
+            {
+                app->startup.object(
+                        scene->transforms.id[slot],
+                        object["type"].get<string>() + " " + object.value("image_name", object.value("text", "")),
+                        object_start);
+            }
         }
     }
 }
@@ -2301,9 +6052,10 @@ void init_screen_objects(AppContext* app, json &objects) {
 
 bool screen_objects_add_lines(AppContext *app)
 {
-    ScreenObject *obj = new LineObject(app->work_area, app->idle_ticks);
+    app->scene->emplace(
+        app->scene->lines, OBJECT_LINES, 0,
+        app->idle_ticks);
 
-    app->screen_objects.push_back(obj);
     app->is_virgin = false;
     app->needs_redraw = true;
 
@@ -2311,9 +6063,51 @@ bool screen_objects_add_lines(AppContext *app)
 }
 
 
+// Creates the default logo and signature objects (used if the settings file defines none)
+bool screen_objects_add_defaults(AppContext *app)
+{
+    float x_pos = (float) app->work_area.x + (float) (app->work_area.w * 5.0 / 6.0);
+    float y_pos = (float) app->work_area.y + (float) (app->work_area.h * 1.0 / 5.0);
+
+    // create image object
+    Uint64 object_start = SDL_GetPerformanceCounter();
+    auto &image = app->scene->emplace(
+            app->scene->images, OBJECT_IMAGE, 0,
+            x_pos, y_pos,
+            app->logo_file_name,
+            app->base_path,
+            app->logo_scale,
+            0.0,
+            false,
+            1.f);
+    if (image.valid()) app->startup.object(image.handle().id, "Image " + app->logo_file_name, object_start);
+
+    // create signature object
+    y_pos += (float) ((float) image.extent().h * image.scale() * 0.6);
+    object_start = SDL_GetPerformanceCounter();
+    auto &text = app->scene->emplace(
+            app->scene->signatures, OBJECT_SIGNATURE, 0,
+            app->text_content,
+            x_pos, y_pos,
+            app->text_font_name,
+            (float) app->text_font_size,
+            app->text_font_color,
+            app->base_path,
+            app->text_scale,
+            app->text_rotate,
+            1.f);
+    if (text.valid()) app->startup.object(text.handle().id, "Signature " + app->text_content, object_start);
+
+    app->is_virgin = false;
+
+    return text.valid() && image.valid();
+}
+
+
 bool screen_objects_add_text(float x, float y, const char* text, AppContext *app)
 {
-    ScreenObject *obj = new Signature(
+    app->scene->emplace(
+        app->scene->signatures, OBJECT_SIGNATURE, 0,
         text,
         x,
         y,
@@ -2323,10 +6117,8 @@ bool screen_objects_add_text(float x, float y, const char* text, AppContext *app
         app->base_path,
         1.f,
         0.f,
-        1.f,
-        app->renderer);
+        1.f);
 
-    app->screen_objects.push_back(obj);
     app->is_virgin = false;
     app->needs_redraw = true;
 
@@ -2336,7 +6128,8 @@ bool screen_objects_add_text(float x, float y, const char* text, AppContext *app
 
 bool screen_objects_add_image(float x, float y, const char *full_path_name, AppContext *app)
 {
-    ScreenObject *obj = nullptr;
+    SceneStore *scene = app->scene;
+    bool valid = false;
     string buffer(full_path_name);
     path fullpath = full_path_name;
 
@@ -2350,15 +6143,19 @@ bool screen_objects_add_image(float x, float y, const char *full_path_name, AppC
         buffer.ends_with(".gif") ||
         buffer.ends_with(".bmp") ||
         buffer.ends_with(".png") ||
+        buffer.ends_with(".webp") ||
         buffer.ends_with(".svg"))
     {
         SDL_PathInfo info;
 
         if (SDL_GetPathInfo(full_path_name, &info) && info.type == SDL_PATHTYPE_FILE)
         {
-            if (buffer.ends_with(".gif"))
+            // Animated WebP and APNG share the GIF animation engine
+            if (buffer.ends_with(".gif") ||
+                ((buffer.ends_with(".webp") || buffer.ends_with(".png")) && image_is_animated(full_path_name)))
             {
-                obj = new AnimatedGif(
+                auto &gif = scene->emplace(
+                        scene->gifs, OBJECT_ANIMATED_GIF, 0,
                         x,
                         y,
                         fullpath.filename().string(),
@@ -2366,46 +6163,197 @@ bool screen_objects_add_image(float x, float y, const char *full_path_name, AppC
                         1.f, 0.f, false,
                         1.f,
                         true,
-                        app->renderer);
+                        0, 0);
 
-                if (obj && !obj->valid())
+                valid = gif.valid();
+                if (valid)
                 {
-                    delete obj;
-                    obj = nullptr;
+                    app->have_animations = true;
                 }
                 else
                 {
-                    app->have_animations = true;
+                    scene->discard_last(scene->gifs);
                 }
             }
             else
             {
-                obj = new Image(
+                auto &image = scene->emplace(
+                        scene->images, OBJECT_IMAGE, 0,
                         x,
                         y,
                         fullpath.filename().string(),
                         fullpath.parent_path().string(),
                         1.f, 0.f, false,
-                        1.f,
-                        app->renderer);
+                        1.f);
 
-                if (obj && !obj->valid())
+                valid = image.valid();
+                if (!valid)
                 {
-                    delete obj;
-                    obj = nullptr;
+                    scene->discard_last(scene->images);
                 }
             }
         }
     }
 
-    if (obj)
+    if (valid)
     {
-        app->screen_objects.push_back(obj);
         app->is_virgin = false;
         app->needs_redraw = true;
     }
 
-    return (bool)obj;
+    return valid;
+}
+
+
+// Adds a dropped image file. Still images are decoded on the job system (background priority), so a large
+// photo doesn't stall input, and the object is created by a continuation once the surface is ready.
+// Loads still running when the scene is freed are cancelled. Animations and files that can't be mapped
+// are loaded in place.
+void screen_objects_load_image(float x, float y, const char *full_path_name, AppContext *app)
+{
+    path fullpath = full_path_name;
+    string full_path = (fullpath.parent_path() / fullpath.filename()).string();
+    string buffer = fullpath.extension().string();
+    SDL_PathInfo info;
+
+    std::transform(
+            buffer.begin(),
+            buffer.end(),
+            buffer.begin(),
+            [](unsigned char c){ return std::tolower(c); });
+
+    bool still = (buffer == ".jpg" || buffer == ".bmp" || buffer == ".png" || buffer == ".webp" || buffer == ".svg") &&
+                 SDL_GetPathInfo(full_path_name, &info) && info.type == SDL_PATHTYPE_FILE &&
+                 !image_is_animated(full_path);
+    const MappedFile *file = still ? asset_cache.map_file(full_path) : nullptr;
+    if (!file)
+    {
+        screen_objects_add_image(x, y, full_path_name, app);
+        return;
+    }
+
+    CancelToken token = app->scene->loads;
+    job_system.submit([=]
+    {
+        SDL_Surface *surface = nullptr;
+        if (!is_cancelled(token))
+        {
+            surface = asset_cache.to_native(IMG_Load_IO(SDL_IOFromConstMem(file->data, file->size), true));
+        }
+
+        // (The mapping goes on the main thread, also if cancelled)
+        job_system.run_on_main([=]
+        {
+            asset_cache.unmap_file(file);
+            if (is_cancelled(token))
+            {
+                SDL_DestroySurface(surface);
+                return;
+            }
+            if (!surface)
+            {
+                SDL_Log("Error loading \"%s\"", full_path.c_str());
+                return;
+            }
+            // (If the object can't be added, releasing the reference drops the surface again)
+            SDL_Surface *cached = asset_cache.add_surface(full_path, surface);
+            screen_objects_add_image(x, y, full_path.c_str(), app);
+            asset_cache.release_surface(cached);
+        });
+    }, JOB_BACKGROUND);
+}
+
+
+// Repeats the topmost image or signature under the cursor as a tiled pattern across the screen ("T" in layout mode).
+// The grid starts at the object, takes its scale, rotation and alpha, and spaces the tiles by twice their size.
+bool screen_objects_add_pattern(AppContext *app)
+{
+    SceneStore *scene = app->scene;
+    SDL_FPoint pt = ScreenObject::cursor_position();
+    json pattern;
+
+    for (Uint32 slot = scene->size(); slot-- > 0 && pattern.empty();)
+    {
+        Uint32 index = scene->transforms.index[slot];
+        switch (scene->transforms.type[slot])
+        {
+            case OBJECT_SIGNATURE:
+                if (scene->signatures[index].valid() && scene->signatures[index].hit_test(pt))
+                {
+                    pattern = scene->signatures[index].to_json();
+                }
+                break;
+            case OBJECT_IMAGE:
+                if (scene->images[index].valid() && scene->images[index].hit_test(pt))
+                {
+                    pattern = scene->images[index].to_json();
+                }
+                break;
+            case OBJECT_ANIMATED_GIF:
+                // (Tiles show the first frame)
+                if (scene->gifs[index].valid() && scene->gifs[index].hit_test(pt))
+                {
+                    pattern = scene->gifs[index].to_json();
+                }
+                break;
+            default:
+                break;
+        }
+        if (!pattern.empty())
+        {
+            const SDL_Rect &ext = scene->transforms.extent[slot];
+            pattern["spacing_x"] = (float)ext.w * 2.f;
+            pattern["spacing_y"] = (float)ext.h * 2.f;
+        }
+    }
+    if (pattern.empty()) return false;
+
+    pattern.erase("id");
+    pattern["type"] = "TiledPattern";
+    auto &tiles = scene->emplace(
+            scene->patterns, OBJECT_TILED_PATTERN, 0,
+            pattern,
+            app->base_path);
+    if (!tiles.valid())
+    {
+        scene->discard_last(scene->patterns);
+        return false;
+    }
+
+    app->is_virgin = false;
+    app->needs_redraw = true;
+
+    return true;
+}
+
+
+// Tells from the file header whether a PNG (acTL chunk before the image data) or WebP (VP8X animation flag) is animated
+bool image_is_animated(const string &full_path)
+{
+    const MappedFile *file = asset_cache.map_file(full_path);
+    if (!file) return false;
+
+    const Uint8 *data = file->data;
+    size_t size = file->size;
+    bool animated = false;
+
+    if (size >= 8 && memcmp(data, "\x89PNG\r\n\x1a\n", 8) == 0)
+    {
+        for (size_t pos = 8; pos + 8 <= size;)
+        {
+            size_t length = (size_t)data[pos] << 24 | data[pos + 1] << 16 | data[pos + 2] << 8 | data[pos + 3];
+            if (memcmp(data + pos + 4, "acTL", 4) == 0) animated = true;
+            if (animated || memcmp(data + pos + 4, "IDAT", 4) == 0) break;
+            pos += 12 + length;
+        }
+    }
+    else if (size >= 21 && memcmp(data, "RIFF", 4) == 0 && memcmp(data + 8, "WEBPVP8X", 8) == 0)
+    {
+        animated = (data[20] & 0x02) != 0;
+    }
+
+    asset_cache.unmap_file(file);
+    return animated;
 }
 
 
@@ -2455,145 +6403,209 @@ double round_to_precision(double value, int decimals)
 
 void free_screen_objects(AppContext* app)
 {
-    for (auto & screen_object : app->screen_objects)
-    {
-        delete screen_object;
-    }
-    app->screen_objects.clear();
+    delete app->scene;
+    app->scene = nullptr;
 }
 
 
 // Implements a Bresenham-like line drawing algorithm with dashing capabilities.
-// This function draws a line between two points (x1, y1) and (x1 + dx, y1 + dy)
-// on a given SDL_Surface. It supports dashed lines with configurable dash and gap lengths.
-void draw_line_bresenham(
+// This function draws the part of the line between (x1, y1) and (x1 + dx, y1 + dy) that falls into
+// `area` (in line layer coordinates) onto a surface whose pixel (0, 0) corresponds to (area.x, area.y).
+// The pixel positions are computed in closed form from the step index, so a line can be clipped
+// to any number of chunks without walking the parts outside, and produces the same pixels and dash
+// pattern in every chunk. There is no limit on the line length.
+// Returns the number of pixels visited inside `area`.
+int draw_line_bresenham(
         int x1, int y1, // Starting coordinates of the line segment
         int dx, int dy, // Differences in x and y coordinates (length of the segment)
         int dash_len,   // Length of a dash in pixels
         int gap_len,    // Length of a gap in pixels
         int dash_offset,// Starting offset for the dashing pattern
-        void *color,    // Pointer to the color data to be used for drawing
-        SDL_Surface* surface) // The target surface to draw on
+        Uint32 color,   // Pixel value to be used for drawing (in the surface's format)
+        SDL_Surface* surface, // The target surface to draw on
+        const SDL_Rect &area) // Region of the line layer covered by the surface
 {
-    // Return immediately if the surface or color is invalid.
-    if (!surface || !color) return;
+    // Return immediately if the surface is invalid.
+    if (!surface || area.w > surface->w || area.h > surface->h) return 0;
 
-    // Determine the direction of the line in x and y axes.
-    int sx = (dx >= 0) ? 1 : -1; // x-step: 1 for right, -1 for left
-    int sy = (dy >= 0) ? 1 : -1; // y-step: 1 for down, -1 for up
+    // Signed ceiling division for positive divisors.
+    auto ceil_div = [](Sint64 a, Sint64 b) -> Sint64 {
+        return (a >= 0) ? (a + b - 1) / b : -((-a) / b);
+    };
 
-    // Initialize error term for Bresenham's algorithm.
-    // This helps decide when to step in the y direction.
-    int err = dx - dy;
+    // Work in surface coordinates.
+    x1 -= area.x;
+    y1 -= area.y;
+
+    // The major axis advances by one pixel per step, the minor axis by the rounded slope.
+    bool x_major = SDL_abs(dx) >= SDL_abs(dy);
+    Sint64 major = x_major ? SDL_abs(dx) : SDL_abs(dy);  // Number of steps
+    Sint64 minor = x_major ? SDL_abs(dy) : SDL_abs(dx);
+    Sint64 m0 = x_major ? x1 : y1;
+    Sint64 n0 = x_major ? y1 : x1;
+    int s_major = ((x_major ? dx : dy) >= 0) ? 1 : -1;
+    int s_minor = ((x_major ? dy : dx) >= 0) ? 1 : -1;
+    Sint64 major_size = x_major ? area.w : area.h;
+    Sint64 minor_size = x_major ? area.h : area.w;
+
+    // Steps k where the major coordinate m0 + s_major * k is inside.
+    Sint64 k0 = (s_major > 0) ? -m0 : m0 - (major_size - 1);
+    Sint64 k1 = (s_major > 0) ? major_size - 1 - m0 : m0;
+    k0 = SDL_max(k0, (Sint64)0);
+    k1 = SDL_min(k1, major);
+
+    // The minor offset after k steps is q(k) = floor((2 * k * minor + major) / (2 * major)),
+    // which is non-decreasing in k. Restrict k to the q range inside the surface.
+    Sint64 q_lo = (s_minor > 0) ? -n0 : n0 - (minor_size - 1);
+    Sint64 q_hi = (s_minor > 0) ? minor_size - 1 - n0 : n0;
+    if (minor > 0)
+    {
+        k0 = SDL_max(k0, ceil_div((2 * q_lo - 1) * major, 2 * minor));
+        k1 = SDL_min(k1, ceil_div((2 * q_hi + 1) * major, 2 * minor) - 1);
+    }
+    else if (q_lo > 0 || q_hi < 0)
+    {
+        return 0;
+    }
+    if (k0 > k1) return 0;
 
     // Get bytes per pixel and pitch (row length in bytes) from the surface.
-    int bpp = 4; // Assuming RGBA8888 format (4 bytes per pixel)
+    int bpp = 4; // Assuming a 32 bit format (4 bytes per pixel)
     int pitch = surface->pitch;
+    int pattern_len = gap_len + dash_len;
 
-    // Pointer to the current pixel address on the surface.
-    void *addr = nullptr;
-
-    // Loop counter to prevent infinite loops for very long lines or zero-length segments.
-    int n = 10000; // Max number of pixels to draw (safety limit)
-
-    // Current position in the dash/gap pattern.
-    int i = dash_offset;
+    // Minor offset and remainder at the first visited step.
+    Sint64 denom = 2 * SDL_max(major, (Sint64)1);
+    Sint64 num = 2 * k0 * minor + major;
+    Sint64 q = num / denom;
+    Sint64 rem = num % denom;
 
-    // Take absolute values of dx and dy for the algorithm.
-    dx = SDL_abs(dx);
-    dy = SDL_abs(dy);
-
-    // Main loop for Bresenham's algorithm.
-    while (n--)
+    for (Sint64 k = k0; k <= k1; k++)
     {
-        int e2; // Error term multiplied by 2 for integer arithmetic
-
-        // Increment dash/gap counter.
-        i++;
-
-        // Check if the current pixel is within the bounds of the surface.
-        if (y1 >= 0 && y1 < surface->h && x1 >= 0 && x1 < surface->w)
-        {
-            // If the address has not been initialized yet, calculate it.
-            if (!addr)
-            {
-                addr = (Uint8 *)surface->pixels + y1 * pitch + x1 * bpp;
-            }
-            // Check if the current segment should be a dash (not a gap).
-            // If gap_len is 0, it's a solid line, so always draw.
-            if (gap_len == 0 || i % (gap_len + dash_len) < dash_len)
-            {
-                // Copy the color data to the current pixel.
-                memcpy(addr, color, bpp);
-            }
-        }
-        else
+        // Position in the dash/gap pattern.
+        // If gap_len is 0, it's a solid line, so always draw.
+        if (gap_len == 0 || ((dash_offset + k + 1) % pattern_len + pattern_len) % pattern_len < dash_len)
         {
-            // If we are outside the surface and have already drawn some pixels,
-            // we can stop drawing. This prevents drawing lines far off-screen.
-            if (addr) break;
+            Sint64 m = m0 + s_major * k;
+            Sint64 n = n0 + s_minor * q;
+            Sint64 x = x_major ? m : n;
+            Sint64 y = x_major ? n : m;
+            *(Uint32 *)((Uint8 *)surface->pixels + y * pitch + x * bpp) = color;
         }
 
-        // Calculate 2 * error for the next step.
-        e2 = 2 * err;
-
-        // Determine whether to step in x, y, or both.
-        if (e2 > -dy) // If error is still positive, step in x direction.
-        {
-            err -= dy; // Update error term.
-            x1 += sx;  // Move to the next pixel in x direction.
-            if (addr) addr = (Uint8 *)addr + sx * bpp; // Update pixel address if applicable.
-        }
-        if (e2 < dx) // If error is still negative, step in y direction.
+        // Advance the minor axis (at most one pixel per step since minor <= major).
+        rem += 2 * minor;
+        if (rem >= denom)
         {
-            err += dx; // Update error term.
-            y1 += sy;  // Move to the next pixel in y direction.
-            if (addr) addr = (Uint8 *)addr + sy * pitch; // Update pixel address if applicable.
+            rem -= denom;
+            q++;
         }
     }
+
+    return (int)(k1 - k0 + 1);
 }
 
 
+
+// Publishes the scene to the render thread (main thread)
 void draw(AppContext* app)
 {
-    SDL_SetRenderDrawBlendMode(app->renderer, SDL_BLENDMODE_BLEND);
+    // (Drag moves are drawn over the cached rest of the scene)
+    if (app->needs_redraw) app->scene_version++;
+
+    SceneSnapshot &snapshot = render_thread.write_buffer();
+    snapshot.capture(app);
+    snapshot.serial = ++app->frame_serial;
+    if (app->latency_stats)
+    {
+        app->latency.published(snapshot.serial);
+    }
+    render_thread.publish(app);
+    app->needs_redraw = false;
+    app->drag_moved = false;
+}
+
+
+// Draws and presents `snapshot` in all windows (render thread). `rastering` tells that a line re-raster was
+// in progress after the previous frame. Returns true if one still is, so another frame is due.
+bool draw_frame(AppContext* app, const SceneSnapshot &snapshot, bool rastering)
+{
+    // Uploads dropped by the main thread since the last frame
+    asset_cache.collect();
+
+    for (OverlayWindow &overlay : app->overlays)
+    {
+        draw_overlay(app, overlay, snapshot, rastering);
+    }
+    if (snapshot.latency_hud)
+    {
+        app->latency.presented(snapshot.serial, SDL_GetTicksNS());
+    }
+    return snapshot.line_object && snapshot.line_object->raster_progressed();
+}
+
+
+// While an object is dragged, the rest of the scene is cached in a target texture, so moving the object
+// costs one blit plus the object itself, whatever the scene holds. The cache is rebuilt when the rest of
+// the scene changes (animation frames, dash jitter, settings) or a line re-raster goes on, and released
+// when the drag ends. (The dragged object is drawn on top while dragged.)
+void draw_overlay(AppContext* app, OverlayWindow &overlay, const SceneSnapshot &snapshot, bool rastering)
+{
+    SDL_Renderer *renderer = overlay.renderer;
+    bool dragging = snapshot.drag_id != 0;
+
+    if (dragging && (rastering || !overlay.drag_background || overlay.drag_background_version != snapshot.scene_version))
+    {
+        dragging = drag_background_update(app, overlay, snapshot);
+    }
+    if (!dragging && overlay.drag_background)
+    {
+        SDL_DestroyTexture(overlay.drag_background);
+        overlay.drag_background = nullptr;
+    }
+
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
     SDL_SetRenderDrawColor(
-        app->renderer,
+        renderer,
         0, 0, 0,
         0
     );
-    SDL_RenderClear(app->renderer);
+    SDL_RenderClear(renderer);
 
-    if (!app->hidden) {
-        for (auto it = app->screen_objects.begin(); it != app->screen_objects.end(); ++it) {
-            if (*it == app->mouse_capture) {
-                SDL_FPoint pt;
+    if (dragging)
+    {
+        SDL_FRect rc = {0.f, 0.f, (float)overlay.area.w, (float)overlay.area.h};
+        SDL_RenderTexture(renderer, overlay.drag_background, nullptr, &rc);
 
-                pt = app->dragging_origin;
-                pt.x -= app->dragging_offset.x;
-                pt.y -= app->dragging_offset.y;
+        const SceneTransforms &view = snapshot.view;
+        for (Uint32 slot = 0; slot < view.size(); slot++)
+        {
+            if (view.id[slot] != snapshot.drag_id || !snapshot.in_view(slot, overlay.area)) continue;
 
-                (*it)->draw(pt, app->alpha, app->renderer);
-            } else {
-                (*it)->draw((*it)->pos, app->alpha, app->renderer);
-            }
+            SDL_FPoint pt = {view.x[slot] - (float)overlay.area.x, view.y[slot] - (float)overlay.area.y};
+            snapshot.draw(slot, pt, overlay, app->batch);
         }
     }
+    else if (!snapshot.hidden)
+    {
+        draw_scene(snapshot, overlay, app->batch, 0);
+    }
+    app->batch.flush(renderer);
 
     // Draw green frame, indicating layout mode
-    if (app->layout_mode)
+    if (snapshot.layout_mode)
     {
         SDL_FRect rc = {
             .x = (float)0,
             .y = (float)0,
-            .w = (float)app->work_area.w,
-            .h = (float)app->work_area.h
+            .w = (float)overlay.area.w,
+            .h = (float)overlay.area.h
         };
         for (int i = 0; i < 6; i++)
         {
-            SDL_SetRenderDrawColor(app->renderer, 0, 200, 0, 50 + i*41);
+            SDL_SetRenderDrawColor(renderer, 0, 200, 0, 50 + i*41);
             SDL_RenderRect(
-                app->renderer,
+                renderer,
                 &rc
             );
             rc.x++;
@@ -2601,10 +6613,174 @@ void draw(AppContext* app)
             rc.w-=2;
             rc.h-=2;
         }
+
+        if (snapshot.latency_hud && overlay.renderer == app->renderer)
+        {
+            draw_latency_hud(app, overlay);
+        }
     }
 
-    SDL_RenderPresent(app->renderer);
-    app->needs_redraw = false;
+    SDL_RenderPresent(renderer);
+}
+
+
+// Latency percentiles per event type, top left in the primary window
+void draw_latency_hud(AppContext* app, const OverlayWindow &overlay)
+{
+    SDL_Renderer *renderer = overlay.renderer;
+    char line[128];
+    float y = 12.f;
+
+    SDL_SetRenderDrawColor(renderer, 0, 200, 0, 255);
+    SDL_RenderDebugText(renderer, 12.f, y, "input to present   count    p50    p95    p99 [ms]");
+    std::lock_guard lock(app->latency.mutex);
+    for (const auto &[type, histogram] : app->latency.histograms)
+    {
+        y += 10.f;
+        SDL_snprintf(
+                line, sizeof(line), "%-16s %7llu %6.1f %6.1f %6.1f",
+                type.c_str(), (unsigned long long)histogram.count,
+                histogram.percentile_ms(0.5), histogram.percentile_ms(0.95), histogram.percentile_ms(0.99));
+        SDL_RenderDebugText(renderer, 12.f, y, line);
+    }
+}
+
+
+// Latency category of an input event (nullptr: not measured)
+const char *latency_event_type(const SDL_Event *event, const AppContext *app)
+{
+    switch (event->type)
+    {
+        case SDL_EVENT_MOUSE_MOTION: return app->mouse_capture ? "drag" : "motion";
+        case SDL_EVENT_MOUSE_WHEEL: return "wheel";
+        case SDL_EVENT_MOUSE_BUTTON_DOWN:
+        case SDL_EVENT_MOUSE_BUTTON_UP: return "button";
+        case SDL_EVENT_KEY_DOWN: return "key";
+        default: return nullptr;
+    }
+}
+
+
+// Writes the latency histograms next to the settings file
+void latency_write(AppContext* app)
+{
+    std::ofstream file(app->base_path / "dragon.latency.json");
+
+    if (file.is_open())
+    {
+        file << app->latency.to_json().dump(4);
+        file.close();
+        SDL_Log("Latency statistics written.");
+    }
+}
+
+
+// Queues all objects of `snapshot` but `skip_id` (the dragged object)
+void draw_scene(const SceneSnapshot &snapshot, const OverlayWindow &overlay, QuadBatch &batch, Uint32 skip_id)
+{
+    const SceneTransforms &tf = snapshot.view;
+    auto dx = (float)overlay.area.x;
+    auto dy = (float)overlay.area.y;
+
+    for (Uint32 slot = 0; slot < tf.size(); slot++) {
+        if (skip_id && tf.id[slot] == skip_id) continue;
+        if (!snapshot.in_view(slot, overlay.area)) continue;
+
+        snapshot.draw(slot, {tf.x[slot] - dx, tf.y[slot] - dy}, overlay, batch);
+    }
+}
+
+
+// Scene position of `slot`, where it's drawn (the drag position while dragged)
+SDL_FPoint object_position(const AppContext *app, Uint32 slot)
+{
+    const SceneTransforms &tf = app->scene->transforms;
+
+    if (app->mouse_capture && tf.id[slot] == app->mouse_capture.id)
+    {
+        return {
+            app->dragging_origin.x - app->dragging_offset.x,
+            app->dragging_origin.y - app->dragging_offset.y
+        };
+    }
+    return {tf.x[slot], tf.y[slot]};
+}
+
+
+// Viewport culling: tests if `slot` (where it's drawn) overlaps `area` (scene coordinates)
+bool object_in_view(const AppContext *app, Uint32 slot, const SDL_Rect &area)
+{
+    return app->scene->transforms.in_view(slot, object_position(app, slot), area);
+}
+
+
+// Tests if `slot` is in view of any overlay window
+bool object_on_screen(const AppContext *app, Uint32 slot)
+{
+    for (const OverlayWindow &overlay : app->overlays)
+    {
+        if (object_in_view(app, slot, overlay.area)) return true;
+    }
+    return false;
+}
+
+
+// Area of the overlay window showing `pt` (scene coordinates), the primary window's if none does
+const SDL_Rect &overlay_area_at(const AppContext *app, SDL_FPoint pt)
+{
+    for (const OverlayWindow &overlay : app->overlays)
+    {
+        const SDL_Rect &area = overlay.area;
+        if (pt.x >= (float)area.x && pt.x < (float)(area.x + area.w) &&
+            pt.y >= (float)area.y && pt.y < (float)(area.y + area.h))
+        {
+            return area;
+        }
+    }
+    return app->overlays.front().area;
+}
+
+
+// Renders the scene without the dragged object into the window's drag background (at backbuffer resolution)
+bool drag_background_update(AppContext* app, OverlayWindow &overlay, const SceneSnapshot &snapshot)
+{
+    SDL_Renderer *renderer = overlay.renderer;
+    int width = (int)lroundf((float)overlay.area.w * overlay.pixel_scale);
+    int height = (int)lroundf((float)overlay.area.h * overlay.pixel_scale);
+
+    if (overlay.drag_background && (overlay.drag_background->w != width || overlay.drag_background->h != height))
+    {
+        SDL_DestroyTexture(overlay.drag_background);
+        overlay.drag_background = nullptr;
+    }
+    if (!overlay.drag_background)
+    {
+        overlay.drag_background = SDL_CreateTexture(
+                renderer, asset_cache.pixel_format, SDL_TEXTUREACCESS_TARGET, width, height);
+        if (!overlay.drag_background)
+        {
+            SDL_Log("Failed to create drag background: %s", SDL_GetError());
+            return false;
+        }
+        // (Copied 1:1 onto the cleared window)
+        SDL_SetTextureBlendMode(overlay.drag_background, SDL_BLENDMODE_NONE);
+        SDL_SetTextureScaleMode(overlay.drag_background, SDL_SCALEMODE_NEAREST);
+    }
+
+    if (!SDL_SetRenderTarget(renderer, overlay.drag_background))
+    {
+        SDL_Log("Failed to render drag background: %s", SDL_GetError());
+        return false;
+    }
+    // (The render scale belongs to the target)
+    SDL_SetRenderScale(renderer, overlay.pixel_scale, overlay.pixel_scale);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+    draw_scene(snapshot, overlay, app->batch, snapshot.drag_id);
+    app->batch.flush(renderer);
+    SDL_SetRenderTarget(renderer, nullptr);
+    overlay.drag_background_version = snapshot.scene_version;
+    return true;
 }
 
 
@@ -2717,6 +6893,11 @@ void settings_write(AppContext* app)
         {"hidden", (bool)app->hidden},
         {"alpha", round_to_precision(app->alpha, 2)},
         {"idle_delay_ms", (int)app->idle_delay_ms},
+        {"timer_slack_ms", (int)app->timer_slack_ms},
+        {"latency_stats", (bool)app->latency_stats},
+        {"all_displays", (bool)app->all_displays},
+        {"render_driver", app->render_driver},
+        {"render_calibration", app->render_calibration},
 
         {"text_file_name", app->text_file_name},
         {"text_content", app->text_content},
@@ -2732,11 +6913,11 @@ void settings_write(AppContext* app)
     };
 
     json objects = json::array();
-    for (auto & screen_object : app->screen_objects)
+    for (Uint32 slot = 0; slot < app->scene->size(); slot++)
     {
-        if (screen_object->valid())
+        if (app->scene->valid(slot))
         {
-            objects.push_back(screen_object->to_json());
+            objects.push_back(app->scene->to_json(slot));
         }
     }
     j["objects"] = objects;
@@ -2876,6 +7057,11 @@ bool settings_read_v0_4(AppContext* app, json &j, json &objects)
     app->alpha = j.value("alpha", app->alpha);
     app->hidden = j.value("hidden", false);
     app->idle_delay_ms = j.value("idle_delay_ms", app->idle_delay_ms);
+    app->timer_slack_ms = SDL_max(0, j.value("timer_slack_ms", app->timer_slack_ms));
+    app->latency_stats = j.value("latency_stats", app->latency_stats);
+    app->all_displays = j.value("all_displays", app->all_displays);
+    app->render_driver = j.value("render_driver", app->render_driver);
+    app->render_calibration = j.value("render_calibration", app->render_calibration);
 
     app->logo_file_name = j.value("logo_file_name", app->logo_file_name);
     app->logo_scale = j.value("logo_scale", app->logo_scale);